@@ -38,6 +38,15 @@ inline Scalar Cotangent(Scalar x) { return 1 / Tangent(x); }
 inline Scalar DegToRad(Scalar x) { return DEGRADRATIO * x; }
 inline Scalar RadToDeg(Scalar x) { return x / DEGRADRATIO; }
 
+/**
+ * Radians: An angle in radians. Functions taking angles in degrees have
+ * overloads taking it, e.g. rotate(Radians(angle), axis).
+ */
+struct Radians {
+  explicit Radians(Scalar angle) : value(angle) {}
+  Scalar value;
+};
+
 /**
  * Power functions.
  */
@@ -11,28 +11,117 @@
 #include <assert.h>
 #include "stdafx.hpp"
 #include "Scalar.hpp"
+#include "BasicMath.hpp"
+#include "Simd.hpp"
 #include "Vector4.hpp"
 
 namespace CoreMath {
 
+/**
+ * Matrix4 - A 4x4 matrix stored by lines, which transforms column vectors.
+ * It is implemented inline and is trivially copyable, as Vector4.
+ */
 class Matrix4 {
 protected:
   Scalar m[16];
+
+  inline Simd::Packet line(int i) const
+  {
+    return Simd::load(m + i * 4);
+  }
+
+  inline Simd::Packet column(int j) const
+  {
+    return Simd::set(m[j], m[4 + j], m[8 + j], m[12 + j]);
+  }
+
+  /**
+   * transformPacket: Transforms four points stored as separate x, y and z
+   * arrays.
+   * @s: The elements of the matrix, each one splatted over a packet.
+   * @translate: Whether the last column is added, as for points.
+   * @project: Whether the results are divided by their w.
+   */
+  static inline void transformPacket(const Simd::Packet* s, const Scalar* x, const Scalar* y, const Scalar* z, Scalar* ox, Scalar* oy, Scalar* oz, bool translate, bool project)
+  {
+    Simd::Packet in[3] = {Simd::load(x), Simd::load(y), Simd::load(z)};
+    Simd::Packet r[4];
+    for(int i = 0; i < (project ? 4 : 3); i++) {
+      r[i] = Simd::mul(s[i * 4], in[0]);
+      r[i] = Simd::add(r[i], Simd::mul(s[i * 4 + 1], in[1]));
+      r[i] = Simd::add(r[i], Simd::mul(s[i * 4 + 2], in[2]));
+      if(translate)
+        r[i] = Simd::add(r[i], s[i * 4 + 3]);
+    }
+    if(project)
+      for(int i = 0; i < 3; i++)
+        r[i] = Simd::div(r[i], r[3]);
+    Simd::store(ox, r[0]);
+    Simd::store(oy, r[1]);
+    Simd::store(oz, r[2]);
+  }
+
+  /**
+   * transformArrays: Shared implementation of transformPoints,
+   * projectPoints and transformDirections over separate coordinate arrays.
+   */
+  inline void transformArrays(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* ox, Scalar* oy, Scalar* oz, int count, bool translate, bool project) const
+  {
+    Simd::Packet s[16];
+    for(int i = 0; i < 16; i++)
+      s[i] = Simd::splat(m[i]);
+    int i = 0;
+    for(; i + 4 <= count; i += 4)
+      transformPacket(s, x + i, y + i, z + i, ox + i, oy + i, oz + i, translate, project);
+    if(i < count) {
+      Scalar in[3][4] = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
+      Scalar out[3][4];
+      for(int k = 0; i + k < count; k++) {
+        in[0][k] = x[i + k];
+        in[1][k] = y[i + k];
+        in[2][k] = z[i + k];
+      }
+      transformPacket(s, in[0], in[1], in[2], out[0], out[1], out[2], translate, project);
+      for(int k = 0; i + k < count; k++) {
+        ox[i + k] = out[0][k];
+        oy[i + k] = out[1][k];
+        oz[i + k] = out[2][k];
+      }
+    }
+  }
 public:
-  Matrix4();
-  Matrix4(const Matrix4& rhs);
-  virtual ~Matrix4();
+  /**
+   * Matrix4: Creates a matrix filled with zeros.
+   */
+  inline Matrix4()
+  {
+    for(int i = 0; i < 16; i++)
+      m[i] = 0;
+  }
 
   /**
    * loadIdentity: Changes the matrix to the Identity.
    */
-  void loadIdentity();
+  inline void loadIdentity()
+  {
+    for(int i = 0; i < 16; i++)
+      m[i] = (i % 5 == 0) ? 1 : 0;
+  }
 
   /**
    * transpose: Transposes the caller matrix. This method alters the
    * matrix.
    */
-  void transpose();
+  inline void transpose()
+  {
+    for(int i = 0; i < 4; i++) {
+      for(int j = i + 1; j < 4; j++) {
+        Scalar t = m[i * 4 + j];
+        m[i * 4 + j] = m[j * 4 + i];
+        m[j * 4 + i] = t;
+      }
+    }
+  }
 
   /**
    * operator[]: Returns a pointer to a line of the matrix to be
@@ -73,12 +162,17 @@ public:
     return m;
   }
 
+  inline const Scalar* getData() const
+  {
+    return m;
+  }
+
   /**
    * getLine: Returns a line of the matrix as a vector.
    * @line: The line to be returned.
    * @returns: A Vector4 containing the line of the matrix.
    */
-  inline Vector4 getLine(const int line)
+  inline Vector4 getLine(const int line) const
   {
     assert(line >= 0 && line < 4);
     return Vector4((*this)[line][0], (*this)[line][1], (*this)[line][2], (*this)[line][3]);
@@ -89,7 +183,7 @@ public:
    * @column: The column to be returned.
    * @returns: A Vector4 containing the column of the matrix.
    */
-  inline Vector4 getColumn(const int column)
+  inline Vector4 getColumn(const int column) const
   {
     assert(column >= 0 && column < 4);
     return Vector4((*this)[0][column], (*this)[1][column], (*this)[2][column], (*this)[3][column]);
@@ -100,7 +194,7 @@ public:
    * @line: The index of the line to be set.
    * @lineContent: The vector containing the new values of the line.
    */
-  inline void setLine(const int line, Vector4 lineContent)
+  inline void setLine(const int line, const Vector4& lineContent)
   {
     assert(line >= 0 && line < 4);
     for(int i = 0; i < 4; i++)
@@ -112,77 +206,228 @@ public:
    * @column: The index of the column to be set.
    * @columnContent: The vector containing the new values of the column.
    */
-  inline void setColumn(const int column, Vector4 columnContent)
+  inline void setColumn(const int column, const Vector4& columnContent)
   {
     assert(column >= 0 && column < 4);
     for(int i = 0; i < 4; i++)
       (*this)[i][column] = columnContent[i];
   }
 
-  /**
-   * operator =: Assignment operator.
-   * @rhs - The source matrix.
-   * @returns - The destination matrix.
-   */
-  Matrix4& operator =(const Matrix4& rhs);
-
   /**
    * operator +: Sum of matrices.
    * @rhs: The matrix to be added.
    * @returns: The matrix containing the sum of *this and rhs.
    */
-  Matrix4 operator +(const Matrix4& rhs);
+  inline Matrix4 operator +(const Matrix4& rhs) const
+  {
+    Matrix4 r;
+    for(int i = 0; i < 4; i++)
+      Simd::store(r.m + i * 4, Simd::add(line(i), rhs.line(i)));
+    return r;
+  }
   
   /**
    * operator -: Difference of matrices.
    * @rhs: The matrix to be subtracted.
    * @returns: The result of *this - rhs.
    */
-  Matrix4 operator -(const Matrix4& rhs);
+  inline Matrix4 operator -(const Matrix4& rhs) const
+  {
+    Matrix4 r;
+    for(int i = 0; i < 4; i++)
+      Simd::store(r.m + i * 4, Simd::sub(line(i), rhs.line(i)));
+    return r;
+  }
 
   /**
    * operator -: Computes the conjugate of the matrix
    * @returns: The conjugated matrix.
    */
-  Matrix4& operator -();
+  inline Matrix4& operator -()
+  {
+    for(int i = 0; i < 16; i++)
+      m[i] = -m[i];
+    return *this;
+  }
 
   /**
-   * operator *: Matrix product.
+   * operator *: Matrix product. Each line of the result is a combination
+   * of the lines of rhs, computed four elements at a time.
    * @rhs: The matrix to be multiplicated.
    * @returns: The resulting matrix of *this * rhs.
    */
-  Matrix4 operator *(const Matrix4& rhs);
+  inline Matrix4 operator *(const Matrix4& rhs) const
+  {
+    Matrix4 r;
+    for(int i = 0; i < 4; i++) {
+      const Scalar* a = m + i * 4;
+      Simd::Packet sum = Simd::mul(Simd::splat(a[0]), rhs.line(0));
+      sum = Simd::add(sum, Simd::mul(Simd::splat(a[1]), rhs.line(1)));
+      sum = Simd::add(sum, Simd::mul(Simd::splat(a[2]), rhs.line(2)));
+      sum = Simd::add(sum, Simd::mul(Simd::splat(a[3]), rhs.line(3)));
+      Simd::store(r.m + i * 4, sum);
+    }
+    return r;
+  }
 
   /**
-   * operator *: Product of a matrix by a vector.
+   * operator *: Product of a matrix by a vector. All of the four
+   * coordinates of rhs are used.
    * @rhs: The vector to be multiplicated.
    * @returns: The resulting vector of *this * rhs.
    */
-  Vector4 operator *(Vector4& rhs);
+  inline Vector4 operator *(const Vector4& rhs) const
+  {
+    Simd::Packet v = Simd::set(rhs[0], rhs[1], rhs[2], rhs[3]);
+    Scalar r[4];
+    Simd::store(r, Simd::sumRows(Simd::mul(line(0), v), Simd::mul(line(1), v), Simd::mul(line(2), v), Simd::mul(line(3), v)));
+    return Vector4(r[0], r[1], r[2], r[3]);
+  }
 
   /**
    * operator ==: Test wheter the matrices are the same.
    * @rhs: The matrix to be tested.
    * @returns: true if the matrices are the same or false otherwise.
    */
-  bool operator ==(const Matrix4& rhs);
+  inline bool operator ==(const Matrix4& rhs) const
+  {
+    for(int i = 0; i < 16; i++)
+      if(m[i] != rhs.m[i])
+        return false;
+    return true;
+  }
 
   /**
    * operator !=: Test wheter the matrices are different
    * @rhs: The matrix to be tested.
    * @returns: true if the matrices are different or false otherwise.
    */
-  bool operator !=(const Matrix4& rhs);
+  inline bool operator !=(const Matrix4& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  /**
+   * transformPoints: Multiplies every vector of an array by the matrix.
+   * The results are the same as the ones of operator *, without a call
+   * and a copy per vector.
+   * @in: The vectors to be transformed.
+   * @out: Receives the transformed vectors. It may be the same array as
+   * in.
+   * @count: Number of vectors.
+   */
+  inline void transformPoints(const Vector4* in, Vector4* out, int count) const
+  {
+    Simd::Packet c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+    for(int i = 0; i < count; i++) {
+      const Scalar* v = in[i].getData();
+      Simd::Packet r = Simd::mul(c0, Simd::splat(v[0]));
+      r = Simd::add(r, Simd::mul(c1, Simd::splat(v[1])));
+      r = Simd::add(r, Simd::mul(c2, Simd::splat(v[2])));
+      r = Simd::add(r, Simd::mul(c3, Simd::splat(v[3])));
+      Simd::store(out[i].getData(), r);
+    }
+  }
+
+  /**
+   * transformDirections: Multiplies the x, y and z of every vector of an
+   * array by the upper 3x3 part of the matrix, so translations do not
+   * apply. The w of the results is 0.
+   * @in: The directions to be transformed.
+   * @out: Receives the transformed directions. It may be the same array as
+   * in.
+   * @count: Number of directions.
+   */
+  inline void transformDirections(const Vector4* in, Vector4* out, int count) const
+  {
+    Simd::Packet c0 = column(0), c1 = column(1), c2 = column(2);
+    for(int i = 0; i < count; i++) {
+      const Scalar* v = in[i].getData();
+      Simd::Packet r = Simd::mul(c0, Simd::splat(v[0]));
+      r = Simd::add(r, Simd::mul(c1, Simd::splat(v[1])));
+      r = Simd::add(r, Simd::mul(c2, Simd::splat(v[2])));
+      Simd::store(out[i].getData(), r);
+      out[i][3] = 0;
+    }
+  }
+
+  /**
+   * transformPoints: Transforms points stored as separate x, y and z
+   * arrays, whose w is 1. Four points are transformed at a time. The last
+   * line of the matrix is not used, see projectPoints for projections.
+   * @x, @y, @z: The coordinates of the points.
+   * @ox, @oy, @oz: Receive the coordinates of the transformed points.
+   * They may be the same arrays as the input.
+   * @count: Number of points.
+   */
+  inline void transformPoints(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* ox, Scalar* oy, Scalar* oz, int count) const
+  {
+    transformArrays(x, y, z, ox, oy, oz, count, true, false);
+  }
+
+  /**
+   * projectPoints: Same as transformPoints, but the transformed points
+   * are divided by their w, as needed by perspective and frustum.
+   */
+  inline void projectPoints(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* ox, Scalar* oy, Scalar* oz, int count) const
+  {
+    transformArrays(x, y, z, ox, oy, oz, count, true, true);
+  }
+
+  /**
+   * transformDirections: Transforms directions stored as separate x, y
+   * and z arrays by the upper 3x3 part of the matrix.
+   * @x, @y, @z: The coordinates of the directions.
+   * @ox, @oy, @oz: Receive the coordinates of the transformed directions.
+   * They may be the same arrays as the input.
+   * @count: Number of directions.
+   */
+  inline void transformDirections(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* ox, Scalar* oy, Scalar* oz, int count) const
+  {
+    transformArrays(x, y, z, ox, oy, oz, count, false, false);
+  }
 };
 
 /**
  * rotate: Creates an arbitrary axis rotation matrix of "angle" 
- * degrees around the "axis" axis.
+ * radians around the "axis" axis.
+ * @angle: The angle of rotation in radians.
+ * @axis: The axis of rotation. It doesn't need to be normalized.
+ * @returns: The arbitrary axis rotation matrix.
+ */
+inline Matrix4 rotate(Radians angle, Vector4 axis)
+{
+  Scalar s = Sine(angle.value);
+  Scalar c = Cosine(angle.value);
+  Scalar t = 1 - c;
+  axis.normalize();
+  Scalar x = axis[0], y = axis[1], z = axis[2];
+  Matrix4 r;
+  r.loadIdentity();
+  r[0][0] = x * x * t + c;
+  r[0][1] = x * y * t - z * s;
+  r[0][2] = x * z * t + y * s;
+  r[1][0] = x * y * t + z * s;
+  r[1][1] = y * y * t + c;
+  r[1][2] = y * z * t - x * s;
+  r[2][0] = x * z * t - y * s;
+  r[2][1] = y * z * t + x * s;
+  r[2][2] = z * z * t + c;
+  return r;
+}
+
+/**
+ * rotate: Creates an arbitrary axis rotation matrix of "angle" 
+ * degrees around the "axis" axis. Angles in radians, which this
+ * function took before, are passed as rotate(Radians(angle), axis).
  * @angle: The angle of rotation in degrees.
  * @axis: The axis of rotation. It doesn't need to be normalized.
  * @returns: The arbitrary axis rotation matrix.
  */
-Matrix4 rotate(Scalar angle, Vector4 axis);
+inline Matrix4 rotate(Scalar angle, Vector4 axis)
+{
+  return rotate(Radians(DegToRad(angle)), axis);
+}
 
 /**
  * translate: Creates a translation matrix and returns it.
@@ -191,7 +436,15 @@ Matrix4 rotate(Scalar angle, Vector4 axis);
  * @z: The amount of translation on the z axis.
  * @returns: The translation matrix.
  */
-Matrix4 translate(Scalar x, Scalar y, Scalar z);
+inline Matrix4 translate(Scalar x, Scalar y, Scalar z)
+{
+  Matrix4 r;
+  r.loadIdentity();
+  r[0][3] = x;
+  r[1][3] = y;
+  r[2][3] = z;
+  return r;
+}
 
 /**
  * scale: Creates a scale matrix and returns it.
@@ -200,18 +453,15 @@ Matrix4 translate(Scalar x, Scalar y, Scalar z);
  * @sz: The amount of scaling on the z axis.
  * @returns: The scale matrix.
  */
-Matrix4 scale(Scalar sx, Scalar sy, Scalar sz);
-
-/**
- * perspective: Creates a perspective projection matrix. Its similar
- * to the gluPerspective function.
- * @fovy: The field of view angle in degrees.
- * @aspectRatio: The aspect ratio of the window (width / height).
- * @near: The distance fo the viewer from the near plane.
- * @far: The distance fo the viewer from the far plane.
- * @returns: The perspective projection matrix.
- */
-Matrix4 perspective(Scalar fovy, Scalar aspectRatio, Scalar near, Scalar far);
+inline Matrix4 scale(Scalar sx, Scalar sy, Scalar sz)
+{
+  Matrix4 r;
+  r.loadIdentity();
+  r[0][0] = sx;
+  r[1][1] = sy;
+  r[2][2] = sz;
+  return r;
+}
 
 /**
  * frustum: Creates a frustum transform matrix. It is made to transform
@@ -225,7 +475,34 @@ Matrix4 perspective(Scalar fovy, Scalar aspectRatio, Scalar near, Scalar far);
  * @far: The distance fo the viewer from the far plane.
  * @returns: The frustum transform matrix.
  */
-Matrix4 frustum(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar near, Scalar far);
+inline Matrix4 frustum(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar near, Scalar far)
+{
+  Matrix4 r;
+  r[0][0] = 2 * near / (right - left);
+  r[0][2] = (right + left) / (right - left);
+  r[1][1] = 2 * near / (top - bottom);
+  r[1][2] = (top + bottom) / (top - bottom);
+  r[2][2] = -(far + near) / (far - near);
+  r[2][3] = -2 * far * near / (far - near);
+  r[3][2] = -1;
+  return r;
+}
+
+/**
+ * perspective: Creates a perspective projection matrix. Its similar
+ * to the gluPerspective function.
+ * @fovy: The field of view angle in degrees.
+ * @aspectRatio: The aspect ratio of the window (width / height).
+ * @near: The distance fo the viewer from the near plane.
+ * @far: The distance fo the viewer from the far plane.
+ * @returns: The perspective projection matrix.
+ */
+inline Matrix4 perspective(Scalar fovy, Scalar aspectRatio, Scalar near, Scalar far)
+{
+  Scalar top = near * Tangent(DegToRad(fovy) * (Scalar) 0.5);
+  Scalar right = top * aspectRatio;
+  return frustum(-right, right, -top, top, near, far);
+}
 
 /**
  * ortho: Creates an orthogonal projection matrix to be applied to
@@ -238,11 +515,23 @@ Matrix4 frustum(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar nea
  * @far: The distance fo the viewer from the far plane.
  * @returns: The orthogonal transform matrix.
  */
-Matrix4 ortho(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar near, Scalar far);
+inline Matrix4 ortho(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar near, Scalar far)
+{
+  Matrix4 r;
+  r.loadIdentity();
+  r[0][0] = 2 / (right - left);
+  r[0][3] = -(right + left) / (right - left);
+  r[1][1] = 2 / (top - bottom);
+  r[1][3] = -(top + bottom) / (top - bottom);
+  r[2][2] = -2 / (far - near);
+  r[2][3] = -(far + near) / (far - near);
+  return r;
+}
 
 /**
  * lookAt: Positions the viewver given it's coordinates, the viewing
- * point and the orientation of the viewer.
+ * point and the orientation of the viewer. It is similar to the
+ * gluLookAt function: the viewer ends at the origin, looking down -z.
  * @eyeX, @eyeY, @eyeZ: The coordinates of the viewer.
  * @centerX, @centerY, @centerZ: The viewing point, where the viewer is
  * looking.
@@ -250,7 +539,24 @@ Matrix4 ortho(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar near,
  * @returns: The camera transform matrix to be applied to the points
  * of the scene.
  */
-Matrix4 lookAt(Scalar eyeX, Scalar eyeY, Scalar eyeZ, Scalar centerX, Scalar centerY, Scalar centerZ, Scalar upX, Scalar upY, Scalar upZ);
+inline Matrix4 lookAt(Scalar eyeX, Scalar eyeY, Scalar eyeZ, Scalar centerX, Scalar centerY, Scalar centerZ, Scalar upX, Scalar upY, Scalar upZ)
+{
+  Vector4 eye(eyeX, eyeY, eyeZ);
+  Vector4 f = (Vector4(centerX, centerY, centerZ) - eye).normalized();
+  Vector4 s = (f ^ Vector4(upX, upY, upZ)).normalized();
+  Vector4 u = s ^ f;
+  Matrix4 r;
+  r.loadIdentity();
+  for(int i = 0; i < 3; i++) {
+    r[0][i] = s[i];
+    r[1][i] = u[i];
+    r[2][i] = -f[i];
+  }
+  r[0][3] = -(s * eye);
+  r[1][3] = -(u * eye);
+  r[2][3] = f * eye;
+  return r;
+}
 
 }
 
@@ -9,41 +9,78 @@
 
 #include "stdafx.hpp"
 #include "Scalar.hpp"
+#include "BasicMath.hpp"
+#include "Simd.hpp"
 
 namespace CoreMath
 {
 
+/**
+ * Quaternion - w + xi + yj + zk, stored as (w, x, y, z). Implemented
+ * inline and trivially copyable, as Vector4.
+ */
 class Quaternion
 {
 protected:
   Scalar m[4];
+
+  inline Simd::Packet packet() const
+  {
+    return Simd::load(m);
+  }
+
+  static inline Quaternion fromPacket(Simd::Packet p)
+  {
+    Quaternion q;
+    Simd::store(q.m, p);
+    return q;
+  }
 public:
-  Quaternion(Scalar _w = 0.0, Scalar _x = 0.0, Scalar _y = 0.0, Scalar _z = 0.0);
-  Quaternion(const Quaternion& rhs);
-  virtual ~Quaternion(void);
+  inline Quaternion(Scalar _w = 0.0, Scalar _x = 0.0, Scalar _y = 0.0, Scalar _z = 0.0)
+  {
+    m[0] = _w;
+    m[1] = _x;
+    m[2] = _y;
+    m[3] = _z;
+  }
 
   /**
    * norm: Calculates the norm of the quaternion. SquareRoot(m[0] * m[0] + m[1] * m[1] + m[2] * m[2] + m[3] * m[3])
    * @return: The norm of the quaternion.
    */
-  Scalar norm();
+  inline Scalar norm() const
+  {
+    return SquareRoot(Simd::sum4(Simd::mul(packet(), packet())));
+  }
 
   /**
    * normalize: Normalize the quaternion.
    */
-  void normalize();
+  inline void normalize()
+  {
+    Simd::store(m, Simd::div(packet(), Simd::splat(norm())));
+  }
 
   /**
    * normalized: Returns a normalized version of the caller quaternion.
    * It does not modify the caller.
    * @returns: A normalized quaternion.
    */
-  Quaternion normalized();
+  inline Quaternion normalized() const
+  {
+    Quaternion q(*this);
+    q.normalize();
+    return q;
+  }
 
   /**
    * loadIdentity: Makes m[0] = 1 and m[1] = m[2] = m[3] = 0.
    */
-  void loadIdentity();
+  inline void loadIdentity()
+  {
+    m[0] = 1;
+    m[1] = m[2] = m[3] = 0;
+  }
 
   /**
    * operator[]: Access operator.
@@ -54,6 +91,11 @@ public:
     return m[i];
   }
 
+  inline Scalar operator[](int i) const
+  {
+    return m[i];
+  }
+
   /**
    * operator <<: Assigns the quaternion to an ostream.
    * @returns: The stream containing the quaternion.
@@ -73,74 +115,105 @@ public:
     return _stream;
   }
 
-  /**
-   * operator =: Assignment operator.
-   * @rhs - The source quaternion.
-   * @returns - The destination quaternion.
-   */
-  Quaternion& operator =(const Quaternion& rhs);
-
   /**
    * operator +: Sum of quaternions.
    * @rhs: The quaternion to be added.
    * @returns: The quaternion containing the sum of *this and rhs.
    */
-  Quaternion operator +(const Quaternion& rhs);
+  inline Quaternion operator +(const Quaternion& rhs) const
+  {
+    return fromPacket(Simd::add(packet(), rhs.packet()));
+  }
   
   /**
    * operator -: Difference of quaternions.
    * @rhs: The quaternion to be subtracted.
    * @returns: The result of *this - rhs.
    */
-  Quaternion operator -(Quaternion& rhs);
+  inline Quaternion operator -(const Quaternion& rhs) const
+  {
+    return fromPacket(Simd::sub(packet(), rhs.packet()));
+  }
 
   /**
    * operator -: Computes the conjugate of the quaternion
    * @returns: The conjugated quaternion.
    */
-  Quaternion& operator -();
+  inline Quaternion& operator -()
+  {
+    m[1] = -m[1];
+    m[2] = -m[2];
+    m[3] = -m[3];
+    return *this;
+  }
 
   /**
    * operator *: Quaternion product.
    * @rhs: The quaternion to bem multiplicated.
    * @returns: The resulting quaternion of *this * rhs.
    */
-  Quaternion operator *(Quaternion& rhs);
+  inline Quaternion operator *(const Quaternion& rhs) const
+  {
+    const Scalar* a = m;
+    const Scalar* b = rhs.m;
+    return Quaternion(a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+                      a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+                      a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+                      a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0]);
+  }
 
   /**
    * operator *: Component wise product of a quaternion by a scalar.
    * @rhs: The scalar.
    * @returns: The result of *this * rhs.
    */
-  Quaternion operator *(Scalar rhs);
+  inline Quaternion operator *(Scalar rhs) const
+  {
+    return fromPacket(Simd::mul(packet(), Simd::splat(rhs)));
+  }
 
   /**
-   * operator /: Quaternion division.
+   * operator /: Quaternion division, the product by the inverse of rhs.
    * @rhs: The quaternion to serve as denominator.
    * @returns: The resulting quaternion *this / rhs.
    */
-  Quaternion operator /(Quaternion& rhs);
+  inline Quaternion operator /(const Quaternion& rhs) const
+  {
+    Scalar n = rhs.norm();
+    Quaternion inverse(rhs);
+    -inverse;
+    return (*this) * (inverse / (n * n));
+  }
 
   /**
    * operator /: Component wise division of a quaternion by a scalar.
    * @rhs: The scalar to serve as denominator.
    * @returns: The resulting quaternion of *this / rhs.
    */
-  Quaternion operator /(Scalar rhs);
+  inline Quaternion operator /(Scalar rhs) const
+  {
+    return fromPacket(Simd::div(packet(), Simd::splat(rhs)));
+  }
 
   /**
    * operator ==: Test wheter the quaternions are the same.
    * @rhs: The quaternion to be tested.
    * @returns: true if the quaternions are the same or false otherwise.
    */
-  bool operator ==(Quaternion& rhs);
+  inline bool operator ==(const Quaternion& rhs) const
+  {
+    return m[0] == rhs.m[0] && m[1] == rhs.m[1] && m[2] == rhs.m[2] && m[3] == rhs.m[3];
+  }
 
   /**
    * operator !=: Test wheter the quaternions are different
    * @rhs: The quaternion to be tested.
    * @returns: true if the quaternions are different or false otherwise.
    */
-  bool operator !=(Quaternion& rhs);
+  inline bool operator !=(const Quaternion& rhs) const
+  {
+    return !(*this == rhs);
+  }
 };
 
 /**
@@ -149,7 +222,10 @@ public:
  * @q2: The second quaternion.
  * @returns: The dot product between q1 and q2.
  */
-Scalar dot(Quaternion q1, Quaternion q2);
+inline Scalar dot(const Quaternion& q1, const Quaternion& q2)
+{
+  return q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3];
+}
 
 /**
  * lerp - Linear interpolation: Computes the linear interpolation
@@ -158,7 +234,10 @@ Scalar dot(Quaternion q1, Quaternion q2);
  * @q2: The second quaternion. Must be normalized.
  * @t: The parameter. Must be between 0 and 1.
  */
-Quaternion lerp(Quaternion q1, Quaternion q2, const Scalar t);
+inline Quaternion lerp(const Quaternion& q1, const Quaternion& q2, const Scalar t)
+{
+  return (q1 * (1 - t) + q2 * t).normalized();
+}
 
 /**
  * slerp - Spherical linear interpolation: Computes the spherical
@@ -167,7 +246,12 @@ Quaternion lerp(Quaternion q1, Quaternion q2, const Scalar t);
  * @q2: The second quaternion. Must be normalized.
  * @t: The parameter. Must be between 0 and 1.
  */
-Quaternion slerp(Quaternion q1, Quaternion q2, const Scalar t);
+inline Quaternion slerp(const Quaternion& q1, const Quaternion& q2, const Scalar t)
+{
+  Scalar theta = ArcCosine(dot(q1, q2));
+  Scalar s = Sine(theta);
+  return q1 * (Sine((1 - t) * theta) / s) + q2 * (Sine(t * theta) / s);
+}
 
 }
 
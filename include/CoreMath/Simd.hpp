@@ -0,0 +1,156 @@
+/**
+ * File: Simd.hpp
+ * Author: agent
+ * Four wide packets of Scalar used by the inline implementations of
+ * Vector4, Matrix4 and Quaternion. Maps to SSE when Scalar is float, to
+ * AVX (or pairs of SSE2 registers) when it is double and to plain arrays
+ * when none of them is enabled by the compiler flags.
+ * File created on October 18, 2026, 06:22
+ */
+
+#ifndef __COREMATH_SIMD_HPP__
+#define __COREMATH_SIMD_HPP__
+
+#include "Scalar.hpp"
+
+#if defined(USE_DOUBLE_PRECISION) && defined(__AVX__)
+#  include <immintrin.h>
+#  define COREMATH_SIMD_AVX
+#elif defined(USE_DOUBLE_PRECISION) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define COREMATH_SIMD_SSE2
+#elif !defined(USE_DOUBLE_PRECISION) && defined(__SSE__)
+#  include <xmmintrin.h>
+#  define COREMATH_SIMD_SSE
+#endif
+
+namespace CoreMath
+{
+
+namespace Simd
+{
+
+/**
+ * Packet - Four Scalars held in registers. Every operation works lane by
+ * lane, so the results are the same on all the implementations.
+ */
+#if defined(COREMATH_SIMD_AVX)
+typedef __m256d Packet;
+
+inline Packet load(const Scalar* p) { return _mm256_loadu_pd(p); }
+inline void store(Scalar* p, Packet a) { _mm256_storeu_pd(p, a); }
+inline Packet set(Scalar x, Scalar y, Scalar z, Scalar w) { return _mm256_set_pd(w, z, y, x); }
+inline Packet splat(Scalar s) { return _mm256_set1_pd(s); }
+inline Packet add(Packet a, Packet b) { return _mm256_add_pd(a, b); }
+inline Packet sub(Packet a, Packet b) { return _mm256_sub_pd(a, b); }
+inline Packet mul(Packet a, Packet b) { return _mm256_mul_pd(a, b); }
+inline Packet div(Packet a, Packet b) { return _mm256_div_pd(a, b); }
+#elif defined(COREMATH_SIMD_SSE2)
+struct Packet {
+  __m128d lo;
+  __m128d hi;
+};
+
+inline Packet make(__m128d lo, __m128d hi) { Packet r = {lo, hi}; return r; }
+inline Packet load(const Scalar* p) { return make(_mm_loadu_pd(p), _mm_loadu_pd(p + 2)); }
+inline void store(Scalar* p, Packet a) { _mm_storeu_pd(p, a.lo); _mm_storeu_pd(p + 2, a.hi); }
+inline Packet set(Scalar x, Scalar y, Scalar z, Scalar w) { return make(_mm_set_pd(y, x), _mm_set_pd(w, z)); }
+inline Packet splat(Scalar s) { return make(_mm_set1_pd(s), _mm_set1_pd(s)); }
+inline Packet add(Packet a, Packet b) { return make(_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)); }
+inline Packet sub(Packet a, Packet b) { return make(_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)); }
+inline Packet mul(Packet a, Packet b) { return make(_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)); }
+inline Packet div(Packet a, Packet b) { return make(_mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi)); }
+#elif defined(COREMATH_SIMD_SSE)
+typedef __m128 Packet;
+
+inline Packet load(const Scalar* p) { return _mm_loadu_ps(p); }
+inline void store(Scalar* p, Packet a) { _mm_storeu_ps(p, a); }
+inline Packet set(Scalar x, Scalar y, Scalar z, Scalar w) { return _mm_set_ps(w, z, y, x); }
+inline Packet splat(Scalar s) { return _mm_set1_ps(s); }
+inline Packet add(Packet a, Packet b) { return _mm_add_ps(a, b); }
+inline Packet sub(Packet a, Packet b) { return _mm_sub_ps(a, b); }
+inline Packet mul(Packet a, Packet b) { return _mm_mul_ps(a, b); }
+inline Packet div(Packet a, Packet b) { return _mm_div_ps(a, b); }
+#else
+struct Packet {
+  Scalar v[4];
+};
+
+inline Packet set(Scalar x, Scalar y, Scalar z, Scalar w) { Packet r = {{x, y, z, w}}; return r; }
+inline Packet load(const Scalar* p) { return set(p[0], p[1], p[2], p[3]); }
+inline void store(Scalar* p, Packet a) { for(int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline Packet splat(Scalar s) { return set(s, s, s, s); }
+inline Packet add(Packet a, Packet b) { return set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+inline Packet sub(Packet a, Packet b) { return set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+inline Packet mul(Packet a, Packet b) { return set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+inline Packet div(Packet a, Packet b) { return set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]); }
+#endif
+
+/**
+ * yzxw - Rotates the first three lanes: (y, z, x, w).
+ */
+inline Packet yzxw(Packet a)
+{
+#if defined(COREMATH_SIMD_SSE)
+  return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+#else
+  Scalar v[4];
+  store(v, a);
+  return set(v[1], v[2], v[0], v[3]);
+#endif
+}
+
+/**
+ * zxyw - Rotates the first three lanes the other way: (z, x, y, w).
+ */
+inline Packet zxyw(Packet a)
+{
+#if defined(COREMATH_SIMD_SSE)
+  return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+#else
+  Scalar v[4];
+  store(v, a);
+  return set(v[2], v[0], v[1], v[3]);
+#endif
+}
+
+/**
+ * sum3 - Adds the first three lanes, as (x + y) + z.
+ */
+inline Scalar sum3(Packet a)
+{
+  Scalar v[4];
+  store(v, a);
+  return v[0] + v[1] + v[2];
+}
+
+/**
+ * sum4 - Adds the four lanes, as ((x + y) + z) + w.
+ */
+inline Scalar sum4(Packet a)
+{
+  Scalar v[4];
+  store(v, a);
+  return v[0] + v[1] + v[2] + v[3];
+}
+
+/**
+ * sumRows - Adds the lanes of each of four packets and returns the four
+ * sums in one packet. The additions are made in the order of sum4, with a
+ * transposition in between so they run four at a time.
+ */
+inline Packet sumRows(Packet r0, Packet r1, Packet r2, Packet r3)
+{
+#if defined(COREMATH_SIMD_SSE)
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  return add(add(add(r0, r1), r2), r3);
+#else
+  return set(sum4(r0), sum4(r1), sum4(r2), sum4(r3));
+#endif
+}
+
+}
+
+}
+
+#endif /* __COREMATH_SIMD_HPP__ */
@@ -10,37 +10,80 @@
 
 #include "stdafx.hpp"
 #include "Scalar.hpp"
+#include "BasicMath.hpp"
+#include "Simd.hpp"
 
 namespace CoreMath
 {
 
+/**
+ * Vector4 - A point or direction in homogeneous coordinates. The class
+ * is implemented inline, has no virtual functions and is trivially
+ * copyable, so arrays of it can be copied with memcpy and the operators
+ * cost no calls. Only x, y and z take part in the norm, the products and
+ * the sums, whose w is 1.
+ */
 class Vector4
 {
 protected:
   Scalar m[4];
+
+  inline Simd::Packet packet() const
+  {
+    return Simd::load(m);
+  }
+
+  /**
+   * fromPacket: Builds a vector from the first three lanes of a packet and
+   * the given w.
+   */
+  static inline Vector4 fromPacket(Simd::Packet p, Scalar w)
+  {
+    Vector4 v;
+    Simd::store(v.m, p);
+    v.m[3] = w;
+    return v;
+  }
 public:
-  Vector4(Scalar x = 0.0, Scalar y = 0.0, Scalar z = 0.0, Scalar w = 1.0);
-  Vector4(const Vector4& rhs);
-  virtual ~Vector4();
+  inline Vector4(Scalar x = 0.0, Scalar y = 0.0, Scalar z = 0.0, Scalar w = 1.0)
+  {
+    m[0] = x;
+    m[1] = y;
+    m[2] = z;
+    m[3] = w;
+  }
 
   /**
    * norm: Returns the norm of the vector.
    * @returns: The norm of teh vector.
    */
-  Scalar norm();
+  inline Scalar norm() const
+  {
+    return SquareRoot((*this) * (*this));
+  }
 
   /**
    * normalize: Normalizes the vector. Note: It modifies the caller,
    * so save its contents first.
    */
-  void normalize();
+  inline void normalize()
+  {
+    Scalar w = m[3];
+    Simd::store(m, Simd::div(packet(), Simd::splat(norm())));
+    m[3] = w;
+  }
 
   /**
    * normalized: Returns a normalized version of the caller vector.
    * It does not modify the caller.
    * @returns: A normalized vector.
    */
-  Vector4 normalized();
+  inline Vector4 normalized() const
+  {
+    Vector4 v(*this);
+    v.normalize();
+    return v;
+  }
 
   /**
    * operator[]: Access operator.
@@ -51,6 +94,24 @@ public:
     return m[i];
   }
 
+  inline Scalar operator [](unsigned int i) const
+  {
+    return m[i];
+  }
+
+  /**
+   * getData: Returns a pointer to the four coordinates of the vector.
+   */
+  inline Scalar* getData()
+  {
+    return m;
+  }
+
+  inline const Scalar* getData() const
+  {
+    return m;
+  }
+
   /**
    * operator <<: Assigns the vector to an ostream.
    * @returns: The stream containing the vector.
@@ -61,67 +122,89 @@ public:
     return _stream;
   }
 
-  /**
-   * operator =: Assignment operator.
-   * @rhs - The source vector.
-   * @returns - The destination vector.
-   */
-  Vector4& operator =(const Vector4& rhs);
-
   /**
    * operator +: Sum of vectors.
    * @rhs: The vector to be added.
    * @returns: The vector containing the sum of *this and rhs.
    */
-  Vector4 operator +(Vector4& rhs);
+  inline Vector4 operator +(const Vector4& rhs) const
+  {
+    return fromPacket(Simd::add(packet(), rhs.packet()), 1);
+  }
 
   /**
    * operator -: Difference of vectors.
    * @rhs: The vector to be subtracted.
    * @returns: The result of *this - rhs.
    */
-  Vector4 operator -(Vector4& rhs);
+  inline Vector4 operator -(const Vector4& rhs) const
+  {
+    return fromPacket(Simd::sub(packet(), rhs.packet()), 1);
+  }
 
   /**
    * operator -: Computes the conjugate of the vector
    * @returns: The conjugated vector.
    */
-  Vector4& operator -();
+  inline Vector4& operator -()
+  {
+    m[0] = -m[0];
+    m[1] = -m[1];
+    m[2] = -m[2];
+    return *this;
+  }
 
   /**
    * operator *: Scalar product.
    * @rhs: The second vector.
    * @returns: The scalar product between the caller and rhs.
    */
-  Scalar operator *(Vector4& rhs);
+  inline Scalar operator *(const Vector4& rhs) const
+  {
+    return Simd::sum3(Simd::mul(packet(), rhs.packet()));
+  }
 
   /**
    * operator *: Component wise product of a vector by a scalar.
    * @rhs: The scalar.
    * @returns: The result of *this * rhs.
    */
-  Vector4 operator *(const Scalar rhs);
+  inline Vector4 operator *(const Scalar rhs) const
+  {
+    return fromPacket(Simd::mul(packet(), Simd::splat(rhs)), 1);
+  }
 
   /**
    * operator ^: Vector product.
    * @rhs: The second vector.
    * @returns: The vector product between the caller and rhs.
    */
-  Vector4 operator ^(Vector4& rhs);
+  inline Vector4 operator ^(const Vector4& rhs) const
+  {
+    Simd::Packet a = packet();
+    Simd::Packet b = rhs.packet();
+    return fromPacket(Simd::sub(Simd::mul(Simd::yzxw(a), Simd::zxyw(b)), Simd::mul(Simd::zxyw(a), Simd::yzxw(b))), 1);
+  }
 
   /**
    * operator ==: Test wheter the vectors are the same.
    * @rhs: The vector to be tested.
    * @returns: true if the vectors are the same or false otherwise.
    */
-  bool operator ==(Vector4& rhs);
+  inline bool operator ==(const Vector4& rhs) const
+  {
+    return m[0] == rhs.m[0] && m[1] == rhs.m[1] && m[2] == rhs.m[2] && m[3] == rhs.m[3];
+  }
 
   /**
    * operator !=: Test wheter the vectors are different
    * @rhs: The vector to be tested.
    * @returns: true if the vectors are different or false otherwise.
    */
-  bool operator !=(Vector4& rhs);
+  inline bool operator !=(const Vector4& rhs) const
+  {
+    return !(*this == rhs);
+  }
 };
 
 }
@@ -0,0 +1,128 @@
+/**
+ * File: AdaptiveTessellation.cpp
+ * Author: agent
+ * Implementation of the adaptive tessellation.
+ * File created on 18 October 2026, 06:31
+ */
+
+#include <cmath>
+#include "AdaptiveTessellation.h"
+
+/**
+ * Deepest subdivision of an interval, so a cusp or a zero tolerance
+ * still ends with at most 2^ADAPTIVE_MAX_DEPTH pieces.
+ */
+#define ADAPTIVE_MAX_DEPTH 16
+
+/**
+ * A point of the curve, in world coordinates and in the space the
+ * tolerance is measured in.
+ */
+struct AdaptivePoint {
+  double world[3];
+  double measured[3];
+};
+
+static void evaluatePoint(const CurveEvaluator& evaluate, const AdaptiveTolerance& tolerance, double u, AdaptivePoint& p)
+{
+  evaluate(u, p.world);
+  if(!tolerance.screenSpace) {
+    for(int c = 0; c < 3; c++)
+      p.measured[c] = p.world[c];
+    return;
+  }
+  CoreMath::Vector4 s = tolerance.screen * CoreMath::Vector4(p.world[0], p.world[1], p.world[2]);
+  p.measured[0] = s[0] / s[3];
+  p.measured[1] = s[1] / s[3];
+  p.measured[2] = 0.0;
+}
+
+/**
+ * distanceToSegment - Distance from p to the segment from a to b.
+ */
+static double distanceToSegment(const double* p, const double* a, const double* b)
+{
+  double ab[3], ap[3];
+  double abab = 0.0, apab = 0.0;
+  for(int c = 0; c < 3; c++) {
+    ab[c] = b[c] - a[c];
+    ap[c] = p[c] - a[c];
+    abab += ab[c] * ab[c];
+    apab += ap[c] * ab[c];
+  }
+  double t = (abab > 0.0) ? apab / abab : 0.0;
+  t = (t < 0.0) ? 0.0 : (t > 1.0) ? 1.0 : t;
+  double d = 0.0;
+  for(int c = 0; c < 3; c++) {
+    double e = ap[c] - t * ab[c];
+    d += e * e;
+  }
+  return std::sqrt(d);
+}
+
+/**
+ * turnAngle - Angle between the segments a-b and b-c, 0 when they are
+ * aligned.
+ */
+static double turnAngle(const double* a, const double* b, const double* c)
+{
+  double u[3], v[3];
+  double uv = 0.0, uu = 0.0, vv = 0.0;
+  for(int k = 0; k < 3; k++) {
+    u[k] = b[k] - a[k];
+    v[k] = c[k] - b[k];
+    uv += u[k] * v[k];
+    uu += u[k] * u[k];
+    vv += v[k] * v[k];
+  }
+  if(uu == 0.0 || vv == 0.0)
+    return 0.0;
+  double cosine = uv / std::sqrt(uu * vv);
+  return std::acos(cosine > 1.0 ? 1.0 : (cosine < -1.0 ? -1.0 : cosine));
+}
+
+static bool isFlat(const AdaptivePoint* p, const AdaptiveTolerance& tolerance)
+{
+  if(tolerance.chordHeight > 0.0)
+    for(int k = 1; k < 4; k++)
+      if(distanceToSegment(p[k].measured, p[0].measured, p[4].measured) > tolerance.chordHeight)
+        return false;
+  if(tolerance.angle > 0.0)
+    for(int k = 1; k < 4; k++)
+      if(turnAngle(p[k - 1].measured, p[k].measured, p[k + 1].measured) > tolerance.angle)
+        return false;
+  return true;
+}
+
+/**
+ * subdivide - Appends the points of the piece [a, b] after a.
+ * @a, @b: The interval.
+ * @pa, @pm, @pb: The points at a, at the middle and at b.
+ * @depth: Number of halvings that led to the piece.
+ */
+static void subdivide(const CurveEvaluator& evaluate, const AdaptiveTolerance& tolerance, double a, double b, const AdaptivePoint& pa, const AdaptivePoint& pm, const AdaptivePoint& pb, int depth, std::vector<double>& points)
+{
+  double m = 0.5 * (a + b);
+  AdaptivePoint p[5];
+  p[0] = pa;
+  p[2] = pm;
+  p[4] = pb;
+  evaluatePoint(evaluate, tolerance, 0.5 * (a + m), p[1]);
+  evaluatePoint(evaluate, tolerance, 0.5 * (m + b), p[3]);
+  if(depth < ADAPTIVE_MAX_DEPTH && !isFlat(p, tolerance)) {
+    subdivide(evaluate, tolerance, a, m, p[0], p[1], p[2], depth + 1, points);
+    subdivide(evaluate, tolerance, m, b, p[2], p[3], p[4], depth + 1, points);
+    return;
+  }
+  points.insert(points.end(), pb.world, pb.world + 3);
+}
+
+void tessellateAdaptive(const CurveEvaluator& evaluate, double a, double b, const AdaptiveTolerance& tolerance, std::vector<double>& points)
+{
+  AdaptivePoint pa, pm, pb;
+  evaluatePoint(evaluate, tolerance, a, pa);
+  evaluatePoint(evaluate, tolerance, 0.5 * (a + b), pm);
+  evaluatePoint(evaluate, tolerance, b, pb);
+  points.insert(points.end(), pa.world, pa.world + 3);
+  subdivide(evaluate, tolerance, a, b, pa, pm, pb, 0, points);
+}
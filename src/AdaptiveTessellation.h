@@ -0,0 +1,83 @@
+/**
+ * File: AdaptiveTessellation.h
+ * Author: agent
+ * Tessellation of a curve segment by recursive subdivision, stopping
+ * where the polyline is close enough to the curve.
+ * File created on 18 October 2026, 06:31
+ */
+
+#ifndef __ADAPTIVETESSELLATION_H__
+#define __ADAPTIVETESSELLATION_H__
+
+#include <vector>
+#include <functional>
+#include <CoreMath/Matrix4.hpp>
+
+/**
+ * AdaptiveTolerance - How close an adaptive tessellation must follow the
+ * curve. A segment of the polyline is accepted when both limits hold.
+ */
+class AdaptiveTolerance {
+public:
+  /**
+   * Largest distance allowed between the curve and the segment
+   * approximating it (the chord height). Ignored when not positive.
+   */
+  double chordHeight;
+
+  /**
+   * Largest turn allowed between consecutive segments, in radians.
+   * Ignored when not positive.
+   */
+  double angle;
+
+  /**
+   * Whether the limits are measured in screen units, on the x and y of
+   * the points transformed by screen and divided by their w, instead of
+   * in world units.
+   */
+  bool screenSpace;
+  CoreMath::Matrix4 screen;
+
+  AdaptiveTolerance(double _chordHeight = 0.0, double _angle = 0.0) : chordHeight(_chordHeight), angle(_angle), screenSpace(false) {}
+
+  /**
+   * setScreen - Measures the limits in screen units.
+   * @matrix: The transform from world to screen coordinates, for example
+   * a projection followed by the viewport.
+   */
+  inline void setScreen(const CoreMath::Matrix4& matrix)
+  {
+    screen = matrix;
+    screenSpace = true;
+  }
+
+  /**
+   * isEnabled - Returns whether any limit is set. Curves use the fixed INC
+   * step otherwise.
+   */
+  inline bool isEnabled() const
+  {
+    return chordHeight > 0.0 || angle > 0.0;
+  }
+};
+
+/**
+ * CurveEvaluator - Computes the x, y and z of a curve at a parameter.
+ */
+typedef std::function<void(double, double*)> CurveEvaluator;
+
+/**
+ * tessellateAdaptive - Tessellates the curve over [a, b]. The interval is
+ * halved until the quarter, middle and three quarter points of each piece
+ * are within the tolerance of its chord, so flat stretches get few
+ * points and tight bends many.
+ * @evaluate: The curve.
+ * @a, @b: The parameter interval.
+ * @tolerance: The limits to be met.
+ * @points: The x, y and z of the points, from a to b inclusive, are
+ * appended to it.
+ */
+void tessellateAdaptive(const CurveEvaluator& evaluate, double a, double b, const AdaptiveTolerance& tolerance, std::vector<double>& points);
+
+#endif /* __ADAPTIVETESSELLATION_H__ */
@@ -0,0 +1,240 @@
+/**
+ * File: BSplineBasis.h
+ * Author: agent
+ * Knot span search and B-Spline blending functions shared by the curves
+ * and surfaces.
+ * File created on 18 October 2026, 06:11
+ */
+
+#ifndef __BSPLINEBASIS_H__
+#define __BSPLINEBASIS_H__
+
+#include <vector>
+
+class BSplineBasis {
+public:
+  /**
+   * reciprocalCount - Returns the size of the arrays filled by
+   * spanReciprocals.
+   * @degree: Degree of the basis.
+   */
+  static inline int reciprocalCount(int degree)
+  {
+    return degree * (degree + 1) / 2;
+  }
+
+  /**
+   * findSpan - Locates the knot span containing a parameter with a
+   * binary search over the knot vector. Parameters outside of the domain
+   * are clamped to its first or last non-empty span.
+   * @knots: The knot vector, with last + degree + 2 positions.
+   * @last: Index of the last control point.
+   * @degree: Degree of the basis.
+   * @u: Parameter.
+   * @hint: A span returned by a previous search. When u lies in it or
+   * in the next span no search is made, so monotone sweeps cost O(1) on
+   * average. Use -1 when there is no hint.
+   * @returns: The index of the span, between degree and last.
+   */
+  static inline int findSpan(const double* knots, int last, int degree, double u, int hint)
+  {
+    if(hint >= degree && hint <= last) {
+      if(u >= knots[hint] && u < knots[hint + 1])
+        return hint;
+      if(hint < last && u >= knots[hint + 1] && u < knots[hint + 2])
+        return hint + 1;
+    }
+    if(u >= knots[last + 1]) {
+      int span = last;
+      while(span > degree && knots[span] == knots[span + 1])
+        span--;
+      return span;
+    }
+    if(u < knots[degree]) {
+      int span = degree;
+      while(span < last && knots[span] == knots[span + 1])
+        span++;
+      return span;
+    }
+    int low = degree;
+    int high = last + 1;
+    int mid = (low + high) / 2;
+    while(u < knots[mid] || u >= knots[mid + 1]) {
+      if(u < knots[mid])
+        high = mid;
+      else
+        low = mid;
+      mid = (low + high) / 2;
+    }
+    return mid;
+  }
+
+  /**
+   * spanReciprocals - Computes the inverses of the knot differences used
+   * by basisFunctions on a knot span. They only depend on the span, so
+   * every parameter evaluated on it shares them.
+   * @knots: The knot vector.
+   * @degree: Degree of the basis.
+   * @span: Index of the knot span.
+   * @inv: Output array with reciprocalCount(degree) positions.
+   */
+  static inline void spanReciprocals(const double* knots, int degree, int span, double* inv)
+  {
+    for(int j = 1; j <= degree; j++) {
+      for(int r = 0; r < j; r++) {
+        double d = knots[span + r + 1] - knots[span + r + 1 - j];
+        inv[j * (j - 1) / 2 + r] = (d != 0) ? 1.0 / d : 0.0;
+      }
+    }
+  }
+
+  /**
+   * basisFunctions - Computes every nonzero B-Spline blending function
+   * of a knot span at once, building the Cox-de Boor triangle from the
+   * degree 0 function up. Costs O(degree^2) instead of the O(2^degree)
+   * of the recursive definition.
+   * @knots: The knot vector.
+   * @degree: Degree of the basis.
+   * @span: Index of the knot span containing u.
+   * @u: Parameter.
+   * @inv: The reciprocals of the span, given by spanReciprocals.
+   * @N: Output array with degree + 1 positions. N[j] receives the
+   * influence of the control point (span - degree + j).
+   */
+  static inline void basisFunctions(const double* knots, int degree, int span, double u, const double* inv, double* N)
+  {
+    switch(degree) {
+    case 1: basisFunctions<1>(knots, span, u, inv, N); return;
+    case 2: basisFunctions<2>(knots, span, u, inv, N); return;
+    case 3: basisFunctions<3>(knots, span, u, inv, N); return;
+    case 4: basisFunctions<4>(knots, span, u, inv, N); return;
+    case 5: basisFunctions<5>(knots, span, u, inv, N); return;
+    }
+    N[0] = 1.0;
+    for(int j = 1; j <= degree; j++) {
+      double saved = 0.0;
+      const double* invRow = inv + j * (j - 1) / 2;
+      for(int r = 0; r < j; r++) {
+        double right = knots[span + r + 1] - u;
+        double left = u - knots[span + r + 1 - j];
+        double temp = N[r] * invRow[r];
+        N[r] = saved + right * temp;
+        saved = left * temp;
+      }
+      N[j] = saved;
+    }
+  }
+
+  /**
+   * cubicBasisFunctions - The cubic triangle of basisFunctions written
+   * out, in the same order of operations as the loops, so the results are
+   * the same.
+   */
+  static inline void cubicBasisFunctions(const double* knots, int span, double u, const double* inv, double* N)
+  {
+    const double* k = knots + span;
+    double r1 = k[1] - u, r2 = k[2] - u, r3 = k[3] - u;
+    double l0 = u - k[0], l1 = u - k[-1], l2 = u - k[-2];
+    double t = inv[0];
+    double n0 = r1 * t;
+    double n1 = l0 * t;
+    t = n0 * inv[1];
+    n0 = r1 * t;
+    double s = l1 * t;
+    t = n1 * inv[2];
+    n1 = s + r2 * t;
+    double n2 = l0 * t;
+    t = n0 * inv[3];
+    N[0] = r1 * t;
+    s = l2 * t;
+    t = n1 * inv[4];
+    N[1] = s + r2 * t;
+    s = l1 * t;
+    t = n2 * inv[5];
+    N[2] = s + r3 * t;
+    N[3] = l0 * t;
+  }
+
+  /**
+   * basisFunctions - Same as above for a degree known at compile time.
+   * The loops have constant bounds and are unrolled by the compiler, and
+   * degree 3 has a hand written version with no loops at all. The
+   * runtime version dispatches to it for degrees 1 to 5.
+   */
+  template<int P>
+  static inline void basisFunctions(const double* knots, int span, double u, const double* inv, double* N)
+  {
+    if(P == 3) {
+      cubicBasisFunctions(knots, span, u, inv, N);
+      return;
+    }
+    N[0] = 1.0;
+    for(int j = 1; j <= P; j++) {
+      double saved = 0.0;
+      const double* invRow = inv + j * (j - 1) / 2;
+      for(int r = 0; r < j; r++) {
+        double right = knots[span + r + 1] - u;
+        double left = u - knots[span + r + 1 - j];
+        double temp = N[r] * invRow[r];
+        N[r] = saved + right * temp;
+        saved = left * temp;
+      }
+      N[j] = saved;
+    }
+  }
+
+  /**
+   * sampleParameters - Lists the parameters tessellated on every
+   * non-empty knot span, from the knot of the span to the next one in
+   * steps of INC.
+   * @knots: The knot vector.
+   * @last: Index of the last control point.
+   * @degree: Degree of the basis.
+   * @step: The parameter step.
+   * @params: Receives the parameters.
+   * @spans: Receives the knot span of each parameter.
+   */
+  static inline void sampleParameters(const double* knots, int last, int degree, double step, std::vector<double>& params, std::vector<int>& spans)
+  {
+    params.clear();
+    spans.clear();
+    for(int span = degree; span <= last; span++) {
+      if(knots[span] == knots[span + 1])
+        continue;
+      for(double u = knots[span]; u <= knots[span + 1]; u += step) {
+        params.push_back(u);
+        spans.push_back(span);
+      }
+    }
+  }
+
+  /**
+   * tabulateBasis - Evaluates the nonzero blending functions at every
+   * parameter listed by sampleParameters. The table only depends on the
+   * knot vector, so it can be shared by every curve or surface direction
+   * built over the same knots.
+   * @knots: The knot vector.
+   * @last: Index of the last control point.
+   * @degree: Degree of the basis.
+   * @step: The parameter step.
+   * @params: Receives the parameters.
+   * @spans: Receives the knot span of each parameter.
+   * @basis: Receives degree + 1 blending functions per parameter.
+   */
+  static inline void tabulateBasis(const double* knots, int last, int degree, double step, std::vector<double>& params, std::vector<int>& spans, std::vector<double>& basis)
+  {
+    sampleParameters(knots, last, degree, step, params, spans);
+    basis.resize(params.size() * (degree + 1));
+    std::vector<double> inv(reciprocalCount(degree) + 1);
+    int span = -1;
+    for(unsigned int k = 0; k < params.size(); k++) {
+      if(spans[k] != span) {
+        span = spans[k];
+        spanReciprocals(knots, degree, span, &inv[0]);
+      }
+      basisFunctions(knots, degree, span, params[k], &inv[0], &basis[k * (degree + 1)]);
+    }
+  }
+};
+
+#endif /* __BSPLINEBASIS_H__ */
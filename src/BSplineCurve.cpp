@@ -7,12 +7,15 @@
 
 #include <iostream>
 #include <cstring>
-#include <GL/glfw.h>
-#include <GL/gl.h>
+#include <cmath>
+#include <algorithm>
+#include <map>
 
 #include "BSplineCurve.h"
+#include "ThreadPool.h"
+#include "ForwardDifference.h"
 
-BSplineCurve::BSplineCurve(int _m, int degree) : m(_m), m_degree(degree)
+BSplineCurve::BSplineCurve(int _m, int degree) : m(_m), m_degree(degree), m_bezierValid(false), m_parallel(false), m_forwardDifferences(false), m_subdivisionLevels(0), m_cache(NULL)
 {
   m_knotVector = new double[m + degree + 1];
   m_weights = new double[m + 1];
@@ -23,59 +26,827 @@ BSplineCurve::BSplineCurve(int _m, int degree) : m(_m), m_degree(degree)
   memset(m_color, 0, 4 * sizeof(double));
 }
 
+BSplineCurve::BSplineCurve(const std::shared_ptr<const ControlNetFile>& file, int index) : m_bezierValid(false), m_parallel(false), m_forwardDifferences(false), m_subdivisionLevels(0), m_cache(NULL), m_net(file)
+{
+  const ControlNetFile::CurveData& data = file->getCurve(index);
+  m = data.m;
+  m_degree = data.degree;
+  //Os dados mapeados sao somente leitura, detachControlNet os copia antes de qualquer escrita.
+  m_knotVector = const_cast<double*>(data.knots);
+  m_weights = const_cast<double*>(data.points + 3 * (size_t) data.stride);
+  m_homogeneousPoints.setView(data.points, m + 1, data.stride);
+  memset(m_color, 0, 4 * sizeof(double));
+}
+
 BSplineCurve::~BSplineCurve()
 {
   m = 0;
   m_degree = 0;
   m_controlPoints.clear();
+  m_homogeneousPoints.clear();
   m_renderPoints.clear();
-  delete[] m_knotVector;
-  delete[] m_weights;
+  if(!m_net) {
+    delete[] m_knotVector;
+    delete[] m_weights;
+  }
+}
+
+void BSplineCurve::detachControlNet()
+{
+  if(!m_net)
+    return;
+  double* knots = new double[m + m_degree + 1];
+  memcpy(knots, m_knotVector, (m + m_degree + 1) * sizeof(double));
+  m_knotVector = knots;
+  double* weights = new double[m + 1];
+  memcpy(weights, m_weights, (m + 1) * sizeof(double));
+  m_weights = weights;
+  m_homogeneousPoints.resize(m + 1);
+  m_controlPoints.resize(m + 1);
+  for(int i = 0; i <= m; i++) {
+    double w = m_homogeneousPoints.w()[i];
+    m_controlPoints[i] = CoreMath::Vector4(m_homogeneousPoints.x()[i] / w, m_homogeneousPoints.y()[i] / w, m_homogeneousPoints.z()[i] / w);
+  }
+  m_net.reset();
+}
+
+void BSplineCurve::updateHomogeneousPoints()
+{
+  m_homogeneousPoints.resize(m_controlPoints.size());
+  for(unsigned int i = 0; i < m_controlPoints.size(); i++) {
+    double w = m_weights[i];
+    m_homogeneousPoints.set(i, m_controlPoints[i][0] * w, m_controlPoints[i][1] * w, m_controlPoints[i][2] * w, w);
+  }
+  m_bezierValid = false;
+}
+
+int BSplineCurve::spanSampleCount(int span)
+{
+  if(m_knotVector[span] == m_knotVector[span + 1]) //Segmentos de comprimento nulo nao contribuem com pontos.
+    return 0;
+  int count = 0;
+  for(double u = m_knotVector[span]; u <= m_knotVector[span + 1]; u += INC)
+    count++;
+  return count;
+}
+
+void BSplineCurve::transform(const CoreMath::Matrix4& matrix)
+{
+  detachControlNet();
+  transformControlPoints(matrix, m_controlPoints);
+  updateHomogeneousPoints();
+  if(!currentRenderPoints().empty())
+    m_pendingTransform.append(matrix);
+}
+
+void BSplineCurve::markDirty(int first, int last)
+{
+  if(m_dirtySpans.empty())
+    return;
+  int firstSpan = std::max(m_degree, first);
+  int lastSpan = std::min(m, last + m_degree);
+  for(int span = firstSpan; span <= lastSpan; span++) {
+    if(!m_dirtySpans[span - m_degree]) {
+      m_dirtySpans[span - m_degree] = 1;
+      m_dirtyList.push_back(span);
+    }
+  }
+}
+
+void BSplineCurve::moveControlPoints(int first, const CoreMath::Vector4* points, int count)
+{
+  detachControlNet();
+  for(int k = 0; k < count; k++) {
+    int i = first + k;
+    double w = m_weights[i];
+    m_controlPoints[i] = points[k];
+    m_homogeneousPoints.set(i, points[k][0] * w, points[k][1] * w, points[k][2] * w, w);
+  }
+  markDirty(first, first + count - 1);
+  if(m_bezierValid) {
+    std::vector<double> scratch(5 * (m_degree + 1));
+    for(int span = std::max(m_degree, first); span <= std::min(m, first + count - 1 + m_degree); span++)
+      bezierSpan(span, &scratch[0]);
+  }
+}
+
+void BSplineCurve::setWeights(int first, const double* weights, int count)
+{
+  detachControlNet();
+  for(int k = 0; k < count; k++) {
+    int i = first + k;
+    double w = weights[k];
+    m_weights[i] = w;
+    m_homogeneousPoints.set(i, m_controlPoints[i][0] * w, m_controlPoints[i][1] * w, m_controlPoints[i][2] * w, w);
+  }
+  markDirty(first, first + count - 1);
+  if(m_bezierValid) {
+    std::vector<double> scratch(5 * (m_degree + 1));
+    for(int span = std::max(m_degree, first); span <= std::min(m, first + count - 1 + m_degree); span++)
+      bezierSpan(span, &scratch[0]);
+  }
+}
+
+void BSplineCurve::updateCurve()
+{
+  //The edits were made on transformed control points, so the pending
+  //transform goes first and the dirty spans are evaluated over it.
+  if(m_pendingTransform.isPending() || !m_dirtyList.empty())
+    detachRenderPoints();
+  m_pendingTransform.apply(m_renderPoints, m_parallel);
+  if(m_dirtyList.empty())
+    return;
+  std::sort(m_dirtyList.begin(), m_dirtyList.end());
+  std::vector<int> runs;
+  for(unsigned int k = 0; k < m_dirtyList.size(); k++) {
+    int span = m_dirtyList[k];
+    m_dirtySpans[span - m_degree] = 0;
+    if(!runs.empty() && runs.back() == span)
+      runs.back() = span + 1;
+    else {
+      runs.push_back(span);
+      runs.push_back(span + 1);
+    }
+  }
+  if(!m_tolerance.isEnabled() && m_subdivisionLevels > 0) { //O poligono refinado nao e dividido por segmento.
+    m_dirtyList.clear();
+    generateSubdivision();
+    return;
+  }
+  if(m_tolerance.isEnabled()) { //Os segmentos adaptativos mudam de tamanho.
+    std::vector<std::vector<double> > points;
+    generateAdaptiveSpans(m_dirtyList, points);
+    assembleAdaptiveSpans(m_dirtyList, points);
+    m_dirtyList.clear();
+    return;
+  }
+  m_dirtyList.clear();
+  if(!m_parallel || runs.size() == 2) {
+    for(unsigned int r = 0; r < runs.size(); r += 2)
+      generateSpans(runs[r], runs[r + 1]);
+    return;
+  }
+  ThreadPool::shared().parallelFor(runs.size() / 2, [this, &runs](int r) {
+    generateSpans(runs[2 * r], runs[2 * r + 1]);
+  });
+}
+
+void BSplineCurve::tessellationKey(TessellationKey& key)
+{
+  key.add('C');
+  key.add(m);
+  key.add(m_degree);
+  key.add(m_knotVector, (m + m_degree + 1) * sizeof(double));
+  //Os pesos sao o w dos pontos homogeneos.
+  for(int c = 0; c < 4; c++)
+    key.add(m_homogeneousPoints.component(c), m_homogeneousPoints.size() * sizeof(double));
+  key.add((double) INC);
+  key.add((int) sizeof(CoreMath::Scalar));
+  key.add(m_tolerance.isEnabled());
+  if(m_tolerance.isEnabled()) {
+    key.add(m_tolerance.chordHeight);
+    key.add(m_tolerance.angle);
+    key.add(m_tolerance.screenSpace);
+    if(m_tolerance.screenSpace)
+      key.add(m_tolerance.screen.getData(), 16 * sizeof(CoreMath::Scalar));
+  }
+  else {
+    key.add(m_subdivisionLevels);
+    key.add(m_forwardDifferences);
+  }
+}
+
+void BSplineCurve::detachRenderPoints()
+{
+  if(m_cached) {
+    m_renderPoints = m_cached->points;
+    m_cached.reset();
+  }
+}
+
+void BSplineCurve::useTessellation(const std::shared_ptr<const Tessellation>& tessellation)
+{
+  m_pendingTransform.cancel();
+  m_dirtyList.clear();
+  m_cached = tessellation;
+  m_spanOffsets = tessellation->spanOffsets;
+  m_dirtySpans.assign(m - m_degree + 1, 0);
+  m_renderPoints = RenderPoints();
+}
+
+void BSplineCurve::storeTessellation(const TessellationKey& key)
+{
+  Tessellation tessellation;
+  tessellation.points = std::move(m_renderPoints);
+  tessellation.spanOffsets = m_spanOffsets;
+  m_cached = m_cache->insert(key, std::move(tessellation));
 }
 
 void BSplineCurve::generateCurve()
 {
-  if(m_renderPoints.empty() == false)
-    m_renderPoints.clear();
-  for(int curveSegment = m_degree; curveSegment <= m; curveSegment++) { //para cada segmento de curva.
+  m_cached.reset();
+  if(m_cache == NULL) {
+    tessellate();
+    return;
+  }
+  TessellationKey key;
+  tessellationKey(key);
+  std::shared_ptr<const Tessellation> cached = m_cache->find(key);
+  if(cached) {
+    useTessellation(cached);
+    return;
+  }
+  tessellate();
+  storeTessellation(key);
+}
+
+void BSplineCurve::tessellate()
+{
+  m_pendingTransform.cancel();
+  m_dirtyList.clear();
+  int spans = m - m_degree + 1;
+  if(m_tolerance.isEnabled()) {
+    std::vector<int> all(spans);
+    for(int s = 0; s < spans; s++)
+      all[s] = m_degree + s;
+    std::vector<std::vector<double> > points;
+    generateAdaptiveSpans(all, points);
+    m_spanOffsets.clear();
+    assembleAdaptiveSpans(all, points);
+    m_dirtySpans.assign(spans, 0);
+    return;
+  }
+  if(m_subdivisionLevels > 0) {
+    m_spanOffsets.clear();
+    generateSubdivision();
+    m_dirtySpans.assign(spans, 0);
+    return;
+  }
+
+  //Each span owns a contiguous slice of m_renderPoints, so the spans can
+  //be filled in any order, by any number of threads.
+  m_spanOffsets.assign(spans + 1, 0);
+  for(int s = 0; s < spans; s++)
+    m_spanOffsets[s + 1] = m_spanOffsets[s] + spanSampleCount(m_degree + s);
+  m_renderPoints.resize(m_spanOffsets[spans], false);
+  m_dirtySpans.assign(spans, 0);
+
+  if(!m_parallel) {
+    generateSpans(m_degree, m + 1);
+    return;
+  }
+  ThreadPool& pool = ThreadPool::shared();
+  int chunks = std::min(spans, 8 * pool.getThreadCount());
+  pool.parallelFor(chunks, [this, spans, chunks](int c) {
+    int first = m_degree + (int) ((long long) spans * c / chunks);
+    int last = m_degree + (int) ((long long) spans * (c + 1) / chunks);
+    generateSpans(first, last);
+  });
+}
+
+void BSplineCurve::generateCurves(const std::vector<BSplineCurve*>& curves, bool parallel)
+{
+  typedef std::pair<std::pair<int, int>, std::vector<double> > FamilyKey;
+  std::map<FamilyKey, std::vector<BSplineCurve*> > families;
+  std::map<BSplineCurve*, TessellationKey> keys;
+  for(unsigned int i = 0; i < curves.size(); i++) {
+    BSplineCurve* c = curves[i];
+    //Forward differencing already skips the basis of polynomial curves.
+    bool polynomial = c->m_forwardDifferences;
+    for(int w = 1; polynomial && w <= c->m; w++)
+      polynomial = c->m_weights[w] == c->m_weights[0];
+    if(c->m_tolerance.isEnabled() || c->m_subdivisionLevels > 0 || polynomial) {
+      c->generateCurve();
+      continue;
+    }
+    c->m_cached.reset();
+    if(c->m_cache != NULL) {
+      TessellationKey& key = keys[c];
+      c->tessellationKey(key);
+      std::shared_ptr<const Tessellation> cached = c->m_cache->find(key);
+      if(cached) {
+        c->useTessellation(cached);
+        continue;
+      }
+    }
+    std::vector<double> knots(c->m_knotVector, c->m_knotVector + c->m + c->m_degree + 1);
+    families[FamilyKey(std::make_pair(c->m, c->m_degree), knots)].push_back(c);
+  }
+  for(auto f = families.begin(); f != families.end(); ++f) {
+    if(f->second.size() == 1)
+      f->second[0]->tessellate();
+    else
+      generateFamily(f->second, parallel);
+    for(unsigned int c = 0; c < f->second.size(); c++)
+      if(f->second[c]->m_cache != NULL)
+        f->second[c]->storeTessellation(keys[f->second[c]]);
+  }
+}
+
+void BSplineCurve::generateFamily(const std::vector<BSplineCurve*>& family, bool parallel)
+{
+  int m = family[0]->m;
+  int p = family[0]->m_degree;
+  int spans = m - p + 1;
+  std::vector<double> params, basis;
+  std::vector<int> sampleSpans;
+  BSplineBasis::tabulateBasis(family[0]->m_knotVector, m, p, INC, params, sampleSpans, basis);
+  std::vector<int> offsets(spans + 1, 0);
+  for(unsigned int k = 0; k < sampleSpans.size(); k++)
+    offsets[sampleSpans[k] - p + 1]++;
+  for(int s = 0; s < spans; s++)
+    offsets[s + 1] += offsets[s];
+
+  for(unsigned int c = 0; c < family.size(); c++) {
+    BSplineCurve* curve = family[c];
+    curve->m_pendingTransform.cancel();
+    curve->m_dirtyList.clear();
+    curve->m_spanOffsets = offsets;
+    curve->m_renderPoints.resize(offsets[spans], false);
+    curve->m_dirtySpans.assign(spans, 0);
+  }
+
+  //Each span is the product of its (samples x (p + 1)) table of blending
+  //functions by the ((p + 1) x 4) homogeneous control points of every
+  //curve. The table stays in cache while the curves go by, and each
+  //curve writes its slice of the span contiguously.
+  auto task = [&family, &offsets, &basis, p](int s) {
+    int span = p + s;
+    int first = offsets[s];
+    int count = offsets[s + 1] - first;
+    if(count == 0)
+      return;
+    for(unsigned int c = 0; c < family.size(); c++) {
+      BSplineCurve* curve = family[c];
+      const double* N = &basis[first * (p + 1)];
+      CoreMath::Scalar* ox = curve->m_renderPoints.x() + first;
+      CoreMath::Scalar* oy = curve->m_renderPoints.y() + first;
+      CoreMath::Scalar* oz = curve->m_renderPoints.z() + first;
+      switch(p) { //Graus ate 5 usam as versoes de grau fixo.
+      case 1: curve->blendSamples<1>(span, N, count, ox, oy, oz); break;
+      case 2: curve->blendSamples<2>(span, N, count, ox, oy, oz); break;
+      case 3: curve->blendSamples<3>(span, N, count, ox, oy, oz); break;
+      case 4: curve->blendSamples<4>(span, N, count, ox, oy, oz); break;
+      case 5: curve->blendSamples<5>(span, N, count, ox, oy, oz); break;
+      default:
+        for(int i = 0; i < count; i++) {
+          double point[3];
+          curve->blend(span, N + i * (p + 1), point);
+          ox[i] = point[0];
+          oy[i] = point[1];
+          oz[i] = point[2];
+        }
+      }
+    }
+  };
+  if(!parallel) {
+    for(int s = 0; s < spans; s++)
+      task(s);
+    return;
+  }
+  ThreadPool::shared().parallelFor(spans, task);
+}
+
+void BSplineCurve::generateSpans(int first, int last)
+{
+  std::vector<double> N(m_degree + 1);
+  std::vector<double> inv(m_degree * (m_degree + 1) / 2 + 1);
+  std::vector<double> params, x, y, z;
+  std::vector<double> coefficients, scratch;
+  for(int curveSegment = first; curveSegment < last; curveSegment++) { //para cada segmento de curva.
+    int count = m_spanOffsets[curveSegment - m_degree + 1] - m_spanOffsets[curveSegment - m_degree];
+    if(count == 0)
+      continue;
+    int offset = m_spanOffsets[curveSegment - m_degree];
+    CoreMath::Scalar* ox = m_renderPoints.x() + offset;
+    CoreMath::Scalar* oy = m_renderPoints.y() + offset;
+    CoreMath::Scalar* oz = m_renderPoints.z() + offset;
+    if(m_forwardDifferences && isPolynomialSpan(curveSegment)) {
+      coefficients.resize(3 * (m_degree + 1));
+      scratch.resize(5 * (m_degree + 1));
+      spanPowerBasis(curveSegment, &N[0], &inv[0], &scratch[0], &coefficients[0]);
+      x.resize(count);
+      y.resize(count);
+      z.resize(count);
+      forwardDifferences(&coefficients[0], m_degree, INC, count, &x[0], &y[0], &z[0]);
+      for(int k = 0; k < count; k++) {
+        ox[k] = x[k];
+        oy[k] = y[k];
+        oz[k] = z[k];
+      }
+      continue;
+    }
+    if(m_degree == 3) { //Curvas cubicas usam os kernels vetorizados.
+      params.clear();
+      for(double u = m_knotVector[curveSegment]; u <= m_knotVector[curveSegment + 1]; u += INC)
+        params.push_back(u);
+      x.resize(count);
+      y.resize(count);
+      z.resize(count);
+      CubicSpan span;
+      cubicSpan(curveSegment, span);
+      evaluateCubicBSpline(span, &params[0], count, &x[0], &y[0], &z[0]);
+      for(int k = 0; k < count; k++) {
+        ox[k] = x[k];
+        oy[k] = y[k];
+        oz[k] = z[k];
+      }
+      continue;
+    }
+    switch(m_degree) { //Graus ate 5 usam as versoes de grau fixo.
+    case 1: sampleSpan<1>(curveSegment, ox, oy, oz); continue;
+    case 2: sampleSpan<2>(curveSegment, ox, oy, oz); continue;
+    case 4: sampleSpan<4>(curveSegment, ox, oy, oz); continue;
+    case 5: sampleSpan<5>(curveSegment, ox, oy, oz); continue;
+    }
+    spanReciprocals(curveSegment, &inv[0]);
+    int k = 0;
     for(double u = m_knotVector[curveSegment]; u <= m_knotVector[curveSegment + 1]; u += INC) { //para cada n pertencente a curva.
-      double acc_x = 0.0;
-      double acc_y = 0.0;
-      double acc_z = 0.0;
-      double r = 0.0; //Fator de normalizacao dos pesos. Eh 1 se todos os pesos forem 1.
-      for(int i = curveSegment - m_degree; i <= curveSegment; i++) { //para cada ponto de controle que influencia esse segmento.
-	acc_x += m_controlPoints[i][0] * m_weights[i] * B(i, m_degree, u);
-	acc_y += m_controlPoints[i][1] * m_weights[i] * B(i, m_degree, u);
-	acc_z += m_controlPoints[i][2] * m_weights[i] * B(i, m_degree, u);
-	r += m_weights[i] * B(i, m_degree, u);
+      basisFunctions(curveSegment, u, &inv[0], &N[0]);
+      double p[3];
+      blend(curveSegment, &N[0], p);
+      ox[k] = p[0];
+      oy[k] = p[1];
+      oz[k] = p[2];
+      k++;
+    }
+  }
+}
+
+bool BSplineCurve::isPolynomialSpan(int span)
+{
+  for(int i = span - m_degree + 1; i <= span; i++)
+    if(m_weights[i] != m_weights[span - m_degree])
+      return false;
+  return true;
+}
+
+void BSplineCurve::spanPowerBasis(int span, double* N, double* inv, double* scratch, double* coefficients)
+{
+  double* samples = scratch;
+  spanReciprocals(span, inv);
+  double length = m_knotVector[span + 1] - m_knotVector[span];
+  for(int k = 0; k <= m_degree; k++) {
+    double u = m_knotVector[span] + ((m_degree > 0) ? length * k / m_degree : 0.0);
+    basisFunctions(span, u, inv, N);
+    blend(span, N, &samples[3 * k]);
+  }
+  interpolatePowerBasis(samples, m_degree, length, scratch + 3 * (m_degree + 1), coefficients);
+}
+
+void BSplineCurve::generateAdaptiveSpans(const std::vector<int>& spans, std::vector<std::vector<double> >& points)
+{
+  points.assign(spans.size(), std::vector<double>());
+  auto task = [this, &spans, &points](int k) {
+    int span = spans[k];
+    if(m_knotVector[span] == m_knotVector[span + 1]) //Segmentos de comprimento nulo nao contribuem com pontos.
+      return;
+    std::vector<double> N(m_degree + 1);
+    std::vector<double> inv(m_degree * (m_degree + 1) / 2 + 1);
+    spanReciprocals(span, &inv[0]);
+    CurveEvaluator evaluate = [this, span, &N, &inv](double u, double* p) {
+      basisFunctions(span, u, &inv[0], &N[0]);
+      blend(span, &N[0], p);
+    };
+    tessellateAdaptive(evaluate, m_knotVector[span], m_knotVector[span + 1], m_tolerance, points[k]);
+  };
+  if(!m_parallel || spans.size() == 1) {
+    for(unsigned int k = 0; k < spans.size(); k++)
+      task(k);
+    return;
+  }
+  ThreadPool::shared().parallelFor(spans.size(), task);
+}
+
+void BSplineCurve::assembleAdaptiveSpans(const std::vector<int>& spans, const std::vector<std::vector<double> >& points)
+{
+  int count = m - m_degree + 1;
+  std::vector<int> offsets(count + 1, 0);
+  unsigned int k = 0;
+  for(int s = 0; s < count; s++) {
+    int n;
+    if(k < spans.size() && spans[k] == m_degree + s)
+      n = points[k++].size() / 3;
+    else
+      n = m_spanOffsets[s + 1] - m_spanOffsets[s];
+    offsets[s + 1] = offsets[s] + n;
+  }
+
+  RenderPoints renderPoints;
+  renderPoints.resize(offsets[count], false);
+  k = 0;
+  for(int s = 0; s < count; s++) {
+    int n = offsets[s + 1] - offsets[s];
+    if(k < spans.size() && spans[k] == m_degree + s) {
+      const std::vector<double>& p = points[k++];
+      for(int i = 0; i < n; i++)
+        renderPoints.set(offsets[s] + i, p[3 * i], p[3 * i + 1], p[3 * i + 2]);
+    } else if(n > 0) { //Segmentos limpos sao copiados como estao.
+      for(int c = 0; c < 3; c++)
+        memcpy(renderPoints.component(c) + offsets[s], m_renderPoints.component(c) + m_spanOffsets[s], n * sizeof(CoreMath::Scalar));
+    }
+  }
+  m_renderPoints = std::move(renderPoints);
+  m_spanOffsets.swap(offsets);
+}
+
+void BSplineCurve::cubicSpan(int span, CubicSpan& s)
+{
+  for(int k = 0; k < 6; k++)
+    s.knots[k] = m_knotVector[span - 2 + k];
+  spanReciprocals(span, s.inv);
+  for(int j = 0; j <= 3; j++)
+    for(int k = 0; k < 4; k++)
+      s.points[4 * j + k] = m_homogeneousPoints.component(k)[span - 3 + j];
+}
+
+CoreMath::Vector4 BSplineCurve::evaluate(double u)
+{
+  int spanHint = -1;
+  return evaluate(u, spanHint);
+}
+
+CoreMath::Vector4 BSplineCurve::evaluate(double u, int& spanHint)
+{
+  const int stackDegree = 8;
+  double stackPoints[4 * (stackDegree + 1)];
+  std::vector<double> heapPoints;
+  double* d = stackPoints;
+  if(m_degree > stackDegree) {
+    heapPoints.resize(4 * (m_degree + 1));
+    d = &heapPoints[0];
+  }
+
+  if(!m_net)
+    updateBezierSegments();
+  int span = findSpan(u, spanHint);
+  spanHint = span;
+  double p[3];
+  evaluateSegment(span, u, d, p);
+  return CoreMath::Vector4(p[0], p[1], p[2]);
+}
+
+void BSplineCurve::evaluateSegment(int span, double u, double* d, double* out)
+{
+  if(m_net) { //Converter uma rede mapeada inteira a copiaria.
+    for(int j = 0; j <= m_degree; j++)
+      for(int k = 0; k < 4; k++)
+        d[4 * j + k] = m_homogeneousPoints.component(k)[span - m_degree + j];
+    for(int r = 1; r <= m_degree; r++) {
+      for(int j = m_degree; j >= r; j--) {
+        double lo = m_knotVector[span - m_degree + j];
+        double hi = m_knotVector[span + 1 + j - r];
+        double alpha = (hi != lo) ? (u - lo) / (hi - lo) : 0.0;
+        for(int k = 0; k < 4; k++)
+          d[4 * j + k] = (1.0 - alpha) * d[4 * (j - 1) + k] + alpha * d[4 * j + k];
+      }
+    }
+    double iw = 1.0 / d[4 * m_degree + 3];
+    out[0] = d[4 * m_degree] * iw;
+    out[1] = d[4 * m_degree + 1] * iw;
+    out[2] = d[4 * m_degree + 2] * iw;
+    return;
+  }
+  double a = m_knotVector[span];
+  double b = m_knotVector[span + 1];
+  double t = (b != a) ? (u - a) / (b - a) : 0.0;
+  int first = (span - m_degree) * (m_degree + 1);
+  //Working on homogeneous points, the rational case needs a single
+  //division at the end.
+  for(int j = 0; j <= m_degree; j++)
+    for(int k = 0; k < 4; k++)
+      d[4 * j + k] = m_bezierPoints.component(k)[first + j];
+  for(int r = 1; r <= m_degree; r++)
+    for(int j = 0; j <= m_degree - r; j++)
+      for(int k = 0; k < 4; k++)
+        d[4 * j + k] = (1.0 - t) * d[4 * j + k] + t * d[4 * (j + 1) + k];
+  double iw = 1.0 / d[3];
+  out[0] = d[0] * iw;
+  out[1] = d[1] * iw;
+  out[2] = d[2] * iw;
+}
+
+void BSplineCurve::bezierSpan(int span, double* scratch)
+{
+  //The Bezier points of the span [a, b) are the blossoms
+  //f(a, ..., a, b, ..., b), which are the control points left by
+  //inserting a and b until each has multiplicity m_degree.
+  double* args = scratch;
+  int first = (span - m_degree) * (m_degree + 1);
+  for(int i = 0; i <= m_degree; i++) {
+    for(int r = 0; r < m_degree; r++)
+      args[r] = (r < m_degree - i) ? m_knotVector[span] : m_knotVector[span + 1];
+    double h[4];
+    blossom(span, args, scratch + m_degree + 1, h);
+    for(int k = 0; k < 4; k++)
+      m_bezierPoints.component(k)[first + i] = h[k];
+  }
+}
+
+void BSplineCurve::blossom(int span, const double* args, double* d, double* out)
+{
+  for(int j = 0; j <= m_degree; j++)
+    for(int k = 0; k < 4; k++)
+      d[4 * j + k] = m_homogeneousPoints.component(k)[span - m_degree + j];
+  for(int r = 1; r <= m_degree; r++) {
+    double u = args[r - 1];
+    for(int j = m_degree; j >= r; j--) {
+      double lo = m_knotVector[span - m_degree + j];
+      double hi = m_knotVector[span + 1 + j - r];
+      double alpha = 0.0;
+      if(hi - lo != 0)
+        alpha = (u - lo) / (hi - lo);
+      for(int k = 0; k < 4; k++)
+        d[4 * j + k] = (1.0 - alpha) * d[4 * (j - 1) + k] + alpha * d[4 * j + k];
+    }
+  }
+  for(int k = 0; k < 4; k++)
+    out[k] = d[4 * m_degree + k];
+}
+
+bool BSplineCurve::hasUniformKnots()
+{
+  double h = m_knotVector[1] - m_knotVector[0];
+  if(h <= 0.0)
+    return false;
+  for(int i = 1; i < m + m_degree; i++)
+    if(std::fabs(m_knotVector[i + 1] - m_knotVector[i] - h) > 1e-12 * h)
+      return false;
+  return true;
+}
+
+void BSplineCurve::generateSubdivision()
+{
+  int p = m_degree;
+  double lo = m_knotVector[p];
+  double hi = m_knotVector[m + 1];
+  //Refined homogeneous control points and the knot vector they are
+  //defined over, of which only the first points.size() + p + 1 matter.
+  std::vector<double> points[4];
+  std::vector<double> greville;
+  if(hasUniformKnots()) {
+    //Lane-Riesenfeld: each level doubles every point and averages the
+    //neighbours p times. The knot spacing is halved and the first knot
+    //moves p half spacings right, as the p points at each end whose
+    //support leaves the old knot vector are dropped.
+    double start = m_knotVector[0];
+    double h = m_knotVector[1] - m_knotVector[0];
+    for(int k = 0; k < 4; k++)
+      points[k].assign(m_homogeneousPoints.component(k), m_homogeneousPoints.component(k) + m + 1);
+    for(int level = 0; level < m_subdivisionLevels; level++) {
+      int n = points[0].size();
+      if(2 * n - p < 1)
+        break;
+      for(int k = 0; k < 4; k++) {
+        std::vector<double>& a = points[k];
+        a.resize(2 * n);
+        for(int i = n - 1; i >= 0; i--)
+          a[2 * i] = a[2 * i + 1] = a[i];
+        for(int r = 0; r < p; r++)
+          for(int i = 0; i < 2 * n - r - 1; i++)
+            a[i] = (a[i] + a[i + 1]) * 0.5;
+        a.resize(2 * n - p);
+      }
+      start += 0.5 * p * h;
+      h *= 0.5;
+    }
+    greville.resize(points[0].size());
+    for(unsigned int i = 0; i < greville.size(); i++)
+      greville[i] = start + h * (i + 0.5 * (p + 1));
+  } else {
+    //Oslo algorithm: every interval is split in 2^levels at once and each
+    //new point is the blossom of the new knots of its support, taken on
+    //an old span inside that support.
+    std::vector<double> knots;
+    int parts = 1 << m_subdivisionLevels;
+    for(int i = 0; i < m + p + 1; i++) {
+      knots.push_back(m_knotVector[i]);
+      if(i < m + p && m_knotVector[i + 1] > m_knotVector[i])
+        for(int s = 1; s < parts; s++)
+          knots.push_back(m_knotVector[i] + (m_knotVector[i + 1] - m_knotVector[i]) * s / parts);
+    }
+    int n = knots.size() - p;
+    std::vector<int> spans(n, -1);
+    for(int i = 0; i < n; i++) {
+      for(int j = i; j <= i + p && j + 1 < (int) knots.size(); j++) {
+        if(knots[j] < knots[j + 1] && knots[j] >= lo && knots[j + 1] <= hi) {
+          spans[i] = findSpan(knots[j], -1);
+          break;
+        }
+      }
+    }
+    for(int k = 0; k < 4; k++)
+      points[k].assign(n, 0.0);
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<std::vector<double> > triangles(m_parallel ? pool.getThreadCount() : 1, std::vector<double>(4 * (p + 1)));
+    auto task = [this, &knots, &spans, &points, &triangles](int i, int thread) {
+      if(spans[i] < 0)
+        return;
+      double h[4];
+      blossom(spans[i], &knots[i + 1], &triangles[thread][0], h);
+      for(int k = 0; k < 4; k++)
+        points[k][i] = h[k];
+    };
+    if(!m_parallel) {
+      for(int i = 0; i < n; i++)
+        task(i, 0);
+    } else
+      pool.parallelFor(n, task);
+    greville.assign(n, lo - 1.0);
+    for(int i = 0; i < n; i++) {
+      if(spans[i] < 0)
+        continue;
+      greville[i] = 0.0;
+      for(int j = 1; j <= p; j++)
+        greville[i] += knots[i + j] / p;
+    }
+  }
+
+  //A refined point is within O(h^2) of the curve at its Greville
+  //abscissa (the average of the knots of its support). Only the points
+  //whose abscissa lies in the domain are kept, and the polygon is closed
+  //with the end points of the curve where the first or last one falls
+  //short of them.
+  int n = points[0].size();
+  int count = 0;
+  std::vector<double> args(p + 1), triangle(4 * (p + 1));
+  auto endPoint = [this, p, &args, &triangle, &count](double u) {
+    double h[4];
+    args.assign(p + 1, u);
+    blossom(findSpan(u, -1), &args[0], &triangle[0], h);
+    m_renderPoints.set(count++, h[0] / h[3], h[1] / h[3], h[2] / h[3]);
+  };
+  m_renderPoints.resize(n + 2, false);
+  double last = lo;
+  for(int i = 0; i < n; i++) {
+    if(greville[i] < lo || greville[i] > hi)
+      continue;
+    if(count == 0 && greville[i] > lo)
+      endPoint(lo);
+    double iw = 1.0 / points[3][i];
+    m_renderPoints.set(count++, points[0][i] * iw, points[1][i] * iw, points[2][i] * iw);
+    last = greville[i];
+  }
+  if(count == 0 || last < hi)
+    endPoint(hi);
+  m_renderPoints.resize(count);
+}
+
+void BSplineCurve::updateBezierSegments()
+{
+  if(m_bezierValid)
+    return;
+  m_bezierPoints.resize((m - m_degree + 1) * (m_degree + 1), false);
+  std::vector<double> scratch(5 * (m_degree + 1));
+  for(int span = m_degree; span <= m; span++)
+    bezierSpan(span, &scratch[0]);
+  m_bezierValid = true;
+}
+
+void BSplineCurve::getBoundingBox(CoreMath::Vector4& min, CoreMath::Vector4& max)
+{
+  updateBezierSegments();
+  bool empty = true;
+  for(int span = m_degree; span <= m; span++) {
+    if(m_knotVector[span] == m_knotVector[span + 1])
+      continue;
+    int first = (span - m_degree) * (m_degree + 1);
+    for(int j = first; j <= first + m_degree; j++) {
+      double iw = 1.0 / m_bezierPoints.w()[j];
+      for(int c = 0; c < 3; c++) {
+        double v = m_bezierPoints.component(c)[j] * iw;
+        if(empty || v < min[c])
+          min[c] = v;
+        if(empty || v > max[c])
+          max[c] = v;
       }
-      m_renderPoints.push_back(CoreMath::Vector4(acc_x / r, acc_y / r, acc_z / r));
+      empty = false;
     }
   }
 }
 
-void BSplineCurve::render()
+void BSplineCurve::evaluate(const double* params, int count, double* out)
 {
-  //Render the control polygon.
-  glColor4f(0.0f, 1.0f, 1.0f, 0.0f);
-  glBegin(GL_LINES);
-  for(unsigned int i = 1; i < m_controlPoints.size(); i++) {
-    glVertex2f(m_controlPoints[i][0], m_controlPoints[i][1]);
-    glVertex2f(m_controlPoints[i - 1][0], m_controlPoints[i - 1][1]);
+  if(count <= 0)
+    return;
+
+  //Sorted input is walked as is, anything else goes through a sorted
+  //permutation so the parameters of a span are evaluated together.
+  std::vector<int> order;
+  if(!std::is_sorted(params, params + count)) {
+    order.resize(count);
+    for(int k = 0; k < count; k++)
+      order[k] = k;
+    std::sort(order.begin(), order.end(), [params](int a, int b) { return params[a] < params[b]; });
   }
-  glEnd();
-  //Render the curve.
-  glColor4f(m_color[0], m_color[1], m_color[2], m_color[3]);
-  glBegin(GL_LINES);
-  for(unsigned int i = 1; i < m_renderPoints.size(); i++) {
-    glVertex2f(m_renderPoints[i][0], m_renderPoints[i][1]);
-    glVertex2f(m_renderPoints[i - 1][0], m_renderPoints[i - 1][1]);
+
+  if(!m_net)
+    updateBezierSegments();
+  std::vector<double> d(4 * (m_degree + 1));
+  int span = -1;
+  for(int k = 0; k < count; k++) {
+    int idx = order.empty() ? k : order[k];
+    span = findSpan(params[idx], span);
+    evaluateSegment(span, params[idx], &d[0], out + 3 * idx);
   }
-  glEnd();
-  //Render the control points.
-  glColor4f(0.0f, 0.0f, 0.0f, 0.0f);
-  glBegin(GL_POINTS);
-  for(unsigned int i = 0; i < m_controlPoints.size(); i++)
-    glVertex2f(m_controlPoints[i][0], m_controlPoints[i][1]);
-  glEnd();
 }
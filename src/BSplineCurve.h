@@ -1,98 +1,690 @@
-/**
- * File: BSplineCurve.h
- * Author: Guilherme Gonalves Schardong
- * Definition of the BSplineCurve class.
- * File created on 05 August 2011, 12:28
- */
-
-#ifndef __BSPLINECURVE_H__
-#define __BSPLINECURVE_H__
-
-#include <vector>
-#include <cstring>
-#include <CoreMath/Vector4.hpp>
-
-#include "main.h"
-
-class BSplineCurve {
-private:
-  int m;
-  int m_degree;
-  double* m_knotVector;
-  double* m_weights;
-  std::vector<CoreMath::Vector4> m_controlPoints;
-  std::vector<CoreMath::Vector4> m_renderPoints;
-  double m_color[4];
-
-  /**
-   * B - B-Spline blending function.
-   * @returns: The Influence of the control point given the paramenter.
-   * @i: i-th control point.
-   * @n: Degree of the curve.
-   * @u: Parameter.
-   */
-  double B(int i/*i-th patch*/, int n/*degree*/, double u/*paramater*/)
-  {
-    if(n == 0) {
-      if(u >= m_knotVector[i] && u < m_knotVector[i + 1])
-	return 1.0;
-      return 0.0;
-    }
-    double f = 0.0;
-    double g = 0.0;
-    if(m_knotVector[i + n] - m_knotVector[i] != 0)
-      f = (u - m_knotVector[i]) / (m_knotVector[i + n] - m_knotVector[i]);
-    if(m_knotVector[i + n + 1] - m_knotVector[i + 1] != 0)
-      g = (m_knotVector[i + n + 1] - u) / (m_knotVector[i + n + 1] - m_knotVector[i + 1]);
-    return f * B(i, n - 1, u) + g * B(i + 1, n - 1, u);
-  }
-public:
-  BSplineCurve(int _m, int degree);
-  ~BSplineCurve();
-
-  inline std::vector<CoreMath::Vector4> getControlPoints()
-  {
-    return m_controlPoints;
-  }
-
-  inline double* getKnotVector()
-  {
-    return m_knotVector;
-  }
-  
-  inline double* getWeights()
-  {
-    return m_weights;
-  }
-  
-  inline void setControlPoints(std::vector<CoreMath::Vector4> controlPoints)
-  {
-    if(!controlPoints.empty())
-      m_controlPoints = controlPoints;
-  }
-
-  inline void setKnotVector(double* knots)
-  {
-    if(knots != NULL)
-      memcpy(m_knotVector, knots, (m + m_degree + 1) * sizeof(double));
-  }
-
-  inline void setWeights(double* weights)
-  {
-    if(weights != NULL)
-      memcpy(m_weights, weights, (m + 1) * sizeof(double));
-  }
-
-  inline void setColor(double r, double g, double b, double a)
-  {
-    m_color[0] = r;
-    m_color[1] = g;
-    m_color[2] = b;
-    m_color[3] = a;
-  }
-
-  void generateCurve();
-  void render();
-};
-
-#endif /* __BSPLINECURVE_H__ */
+/**
+ * File: BSplineCurve.h
+ * Author: Guilherme Gonalves Schardong
+ * Definition of the BSplineCurve class.
+ * File created on 05 August 2011, 12:28
+ */
+
+#ifndef __BSPLINECURVE_H__
+#define __BSPLINECURVE_H__
+
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <memory>
+#include <CoreMath/Vector4.hpp>
+
+#include "main.h"
+#include "SimdKernels.h"
+#include "BSplineBasis.h"
+#include "PointArray.h"
+#include "PointTransform.h"
+#include "AdaptiveTessellation.h"
+#include "TessellationCache.h"
+#include "ControlNetFile.h"
+
+class BSplineCurve {
+private:
+  int m;
+  int m_degree;
+  double* m_knotVector;
+  double* m_weights;
+  std::vector<CoreMath::Vector4> m_controlPoints;
+  HomogeneousPoints m_homogeneousPoints;
+  HomogeneousPoints m_bezierPoints;
+  bool m_bezierValid;
+  RenderPoints m_renderPoints;
+  std::vector<int> m_spanOffsets;
+  std::vector<char> m_dirtySpans;
+  std::vector<int> m_dirtyList;
+  PendingTransform m_pendingTransform;
+  AdaptiveTolerance m_tolerance;
+  bool m_parallel;
+  bool m_forwardDifferences;
+  int m_subdivisionLevels;
+  TessellationCache* m_cache;
+  std::shared_ptr<const Tessellation> m_cached;
+  std::shared_ptr<const ControlNetFile> m_net;
+  double m_color[4];
+
+  /**
+   * detachControlNet - Copies the knots, weights and control points of a
+   * curve built from a ControlNetFile to storage of its own, before they
+   * are modified or handed out for writing. Does nothing for other
+   * curves.
+   */
+  void detachControlNet();
+
+  /**
+   * tessellationKey - Builds the key of the tessellation of the curve in
+   * a TessellationCache: its definition and every setting generateCurve
+   * depends on.
+   * @key: The key to be filled.
+   */
+  void tessellationKey(TessellationKey& key);
+
+  /**
+   * currentRenderPoints - Returns the tessellation in use: the cached one
+   * shared with other curves or m_renderPoints.
+   */
+  inline const RenderPoints& currentRenderPoints() const
+  {
+    return m_cached ? m_cached->points : m_renderPoints;
+  }
+
+  /**
+   * detachRenderPoints - Copies a cached tessellation to m_renderPoints
+   * before it is modified, so the cached one is never changed.
+   */
+  void detachRenderPoints();
+
+  /**
+   * useTessellation - Adopts a cached tessellation instead of computing
+   * one, as generateCurve would.
+   * @tessellation: The tessellation, made for the same key.
+   */
+  void useTessellation(const std::shared_ptr<const Tessellation>& tessellation);
+
+  /**
+   * storeTessellation - Moves the tessellation just computed to the
+   * cache and starts sharing it.
+   * @key: The key of the curve, built before the tessellation.
+   */
+  void storeTessellation(const TessellationKey& key);
+
+  /**
+   * tessellate - Tessellates the whole curve into m_renderPoints, with
+   * the mode chosen by the settings. See generateCurve.
+   */
+  void tessellate();
+
+  /**
+   * spanReciprocals - Computes the knot difference reciprocals of a span
+   * of the curve. See BSplineBasis::spanReciprocals.
+   * @span: Index of the knot span (m_degree <= span <= m).
+   * @inv: Output array with m_degree * (m_degree + 1) / 2 positions.
+   */
+  inline void spanReciprocals(int span, double* inv)
+  {
+    BSplineBasis::spanReciprocals(m_knotVector, m_degree, span, inv);
+  }
+
+  /**
+   * basisFunctions - Computes the m_degree + 1 nonzero blending functions
+   * of the curve at u. See BSplineBasis::basisFunctions.
+   * @span: Index of the knot span containing u (m_degree <= span <= m).
+   * @u: Parameter.
+   * @inv: The reciprocals of the span, given by spanReciprocals.
+   * @N: Output array with m_degree + 1 positions. N[j] receives the
+   * influence of the control point (span - m_degree + j).
+   */
+  inline void basisFunctions(int span, double u, const double* inv, double* N)
+  {
+    BSplineBasis::basisFunctions(m_knotVector, m_degree, span, u, inv, N);
+  }
+
+  /**
+   * updateHomogeneousPoints - Rebuilds m_homogeneousPoints, the control
+   * points premultiplied by their weights, with the weight itself in the
+   * w component: (x * w, y * w, z * w, w). Evaluating over them needs one
+   * basis pass, a single 4-wide accumulation and one division per point,
+   * the same work as a non-rational curve.
+   */
+  void updateHomogeneousPoints();
+
+  /**
+   * blend - Combines the homogeneous control points of a span with its
+   * blending functions and projects the result back to 3D.
+   * @span: Index of the knot span.
+   * @N: The m_degree + 1 blending functions of the span.
+   * @out: Receives the x, y and z coordinates of the point.
+   */
+  inline void blend(int span, const double* N, double* out)
+  {
+    double h[4] = {0.0, 0.0, 0.0, 0.0};
+    int first = span - m_degree;
+    for(int k = 0; k < 4; k++) {
+      const double* P = m_homogeneousPoints.component(k) + first;
+      for(int j = 0; j <= m_degree; j++)
+        h[k] += N[j] * P[j];
+    }
+    double iw = 1.0 / h[3];
+    out[0] = h[0] * iw;
+    out[1] = h[1] * iw;
+    out[2] = h[2] * iw;
+  }
+
+  /**
+   * blend - Same as above for a degree P known at compile time.
+   */
+  template<int P>
+  inline void blend(int span, const double* N, double* out)
+  {
+    double h[4] = {0.0, 0.0, 0.0, 0.0};
+    int first = span - P;
+    for(int k = 0; k < 4; k++) {
+      const double* points = m_homogeneousPoints.component(k) + first;
+      for(int j = 0; j <= P; j++)
+        h[k] += N[j] * points[j];
+    }
+    double iw = 1.0 / h[3];
+    out[0] = h[0] * iw;
+    out[1] = h[1] * iw;
+    out[2] = h[2] * iw;
+  }
+
+  /**
+   * blendSamples - Applies blend<P> to many samples of a knot span whose
+   * blending functions are already known, with the control points of the
+   * span held in registers.
+   * @span: Index of the knot span.
+   * @N: P + 1 blending functions per sample.
+   * @count: Number of samples.
+   * @ox, @oy, @oz: Receive the coordinates of the points.
+   */
+  template<int P>
+  void blendSamples(int span, const double* N, int count, CoreMath::Scalar* ox, CoreMath::Scalar* oy, CoreMath::Scalar* oz)
+  {
+    double points[4][P + 1];
+    for(int k = 0; k < 4; k++)
+      for(int j = 0; j <= P; j++)
+        points[k][j] = m_homogeneousPoints.component(k)[span - P + j];
+    for(int i = 0; i < count; i++, N += P + 1) {
+      double h[4];
+      for(int k = 0; k < 4; k++) {
+        h[k] = N[0] * points[k][0];
+        for(int j = 1; j <= P; j++)
+          h[k] += N[j] * points[k][j];
+      }
+      double iw = 1.0 / h[3];
+      ox[i] = h[0] * iw;
+      oy[i] = h[1] * iw;
+      oz[i] = h[2] * iw;
+    }
+  }
+
+  /**
+   * sampleSpan - Evaluates a knot span in steps of INC, as generateSpans,
+   * for a degree P known at compile time. The basis and its reciprocals
+   * live in arrays of constant size on the stack.
+   * @span: Index of the knot span. P must be equal to m_degree.
+   * @ox, @oy, @oz: The slice of the span in m_renderPoints.
+   */
+  template<int P>
+  void sampleSpan(int span, CoreMath::Scalar* ox, CoreMath::Scalar* oy, CoreMath::Scalar* oz)
+  {
+    double N[P + 1];
+    double inv[P * (P + 1) / 2 + 1];
+    BSplineBasis::spanReciprocals(m_knotVector, P, span, inv);
+    int k = 0;
+    for(double u = m_knotVector[span]; u <= m_knotVector[span + 1]; u += INC) {
+      BSplineBasis::basisFunctions<P>(m_knotVector, span, u, inv, N);
+      double p[3];
+      blend<P>(span, N, p);
+      ox[k] = p[0];
+      oy[k] = p[1];
+      oz[k] = p[2];
+      k++;
+    }
+  }
+
+  /**
+   * cubicSpan - Gathers the data the cubic kernels need for a knot span.
+   * Only valid when m_degree is 3.
+   * @span: Index of the knot span.
+   * @s: The span description to be filled.
+   */
+  void cubicSpan(int span, CubicSpan& s);
+
+  /**
+   * spanSampleCount - Returns how many points generateCurve produces on a
+   * knot span.
+   * @span: Index of the knot span.
+   */
+  int spanSampleCount(int span);
+
+  /**
+   * generateSpans - Tessellates a range of knot spans into their slices
+   * of m_renderPoints, given by m_spanOffsets.
+   * @first: First span of the range.
+   * @last: One past the last span of the range.
+   */
+  void generateSpans(int first, int last);
+
+  /**
+   * isPolynomialSpan - Returns whether the weights of a knot span are all
+   * equal, in which case they cancel out and the span is a polynomial.
+   */
+  bool isPolynomialSpan(int span);
+
+  /**
+   * spanPowerBasis - Converts a polynomial knot span to the power basis
+   * of t = u - U[span].
+   * @span: The knot span.
+   * @N, @inv: Scratch for basisFunctions.
+   * @scratch: Room for 5 * (m_degree + 1) values.
+   * @coefficients: Receives 3 * (m_degree + 1) values, laid out as in
+   * bezierPowerBasis.
+   */
+  void spanPowerBasis(int span, double* N, double* inv, double* scratch, double* coefficients);
+
+  /**
+   * markDirty - Flags the knot spans influenced by a range of control
+   * points for re-evaluation by updateCurve.
+   * @first: First control point of the range.
+   * @last: Last control point of the range.
+   */
+  void markDirty(int first, int last);
+
+  /**
+   * generateAdaptiveSpans - Tessellates knot spans with
+   * tessellateAdaptive.
+   * @spans: The knot spans.
+   * @points: Receives the x, y and z of the points of each span.
+   */
+  void generateAdaptiveSpans(const std::vector<int>& spans, std::vector<std::vector<double> >& points);
+
+  /**
+   * assembleAdaptiveSpans - Rebuilds m_renderPoints and m_spanOffsets
+   * from new points for some knot spans, keeping the current points of
+   * the other ones.
+   * @spans: The knot spans with new points, in increasing order.
+   * @points: The points of each of them.
+   */
+  void assembleAdaptiveSpans(const std::vector<int>& spans, const std::vector<std::vector<double> >& points);
+
+  /**
+   * findSpan - Locates the knot span of the curve containing u. See
+   * BSplineBasis::findSpan.
+   * @u: Parameter.
+   * @hint: A span returned by a previous search, or -1.
+   * @returns: The index of the span, between m_degree and m.
+   */
+  inline int findSpan(double u, int hint)
+  {
+    return BSplineBasis::findSpan(m_knotVector, m, m_degree, u, hint);
+  }
+
+  /**
+   * bezierSpan - Converts a knot span to its Bezier form, stored in
+   * m_bezierPoints. See getBezierSegments.
+   * @span: Index of the knot span.
+   * @scratch: Room for 5 * (m_degree + 1) values.
+   */
+  void bezierSpan(int span, double* scratch);
+
+  /**
+   * blossom - Evaluates the blossom (polar form) of the polynomial piece
+   * of a knot span with a de Boor triangle whose r-th level uses args[r - 1]
+   * instead of a single parameter. With all the arguments equal to u it
+   * is the point at u.
+   * @span: Index of the knot span.
+   * @args: The m_degree arguments.
+   * @d: Scratch for the triangle, 4 * (m_degree + 1) values.
+   * @out: Receives the homogeneous point (x * w, y * w, z * w, w).
+   */
+  void blossom(int span, const double* args, double* d, double* out);
+
+  /**
+   * hasUniformKnots - Returns whether all the knots are equally spaced.
+   */
+  bool hasUniformKnots();
+
+  /**
+   * generateSubdivision - Tessellates the curve as its control polygon
+   * refined m_subdivisionLevels times. See setSubdivisionLevels.
+   */
+  void generateSubdivision();
+
+  /**
+   * generateFamily - Tessellates curves with the same knot vector and
+   * degree, evaluating the basis once for all of them. See
+   * generateCurves.
+   * @family: The curves, at least one.
+   * @parallel: Whether the knot spans are split among the threads of
+   * ThreadPool::shared().
+   */
+  static void generateFamily(const std::vector<BSplineCurve*>& family, bool parallel);
+
+  /**
+   * updateBezierSegments - Converts every knot span to its Bezier form
+   * when the cached one is out of date.
+   */
+  void updateBezierSegments();
+
+  /**
+   * evaluateSegment - Evaluates the Bezier form of a knot span with de
+   * Casteljau's algorithm. Curves built from a ControlNetFile are not
+   * converted and run de Boor's algorithm on the mapped points instead.
+   * @span: Index of the knot span, already converted.
+   * @u: Parameter.
+   * @d: Scratch buffer with 4 * (m_degree + 1) positions.
+   * @out: Receives the x, y and z coordinates of the point.
+   */
+  void evaluateSegment(int span, double u, double* d, double* out);
+public:
+  BSplineCurve(int _m, int degree);
+
+  /**
+   * BSplineCurve - Builds a curve over the data of a memory mapped
+   * ControlNetFile, without copying it. The knots and homogeneous control
+   * points are read in place by every evaluation and tessellation, so
+   * only the pages actually used are loaded. Editing the curve, or asking
+   * for its control points, knots or weights, copies the data first.
+   * @file: The open file, kept mapped while the curve uses it.
+   * @index: Index of the curve in the file.
+   */
+  BSplineCurve(const std::shared_ptr<const ControlNetFile>& file, int index);
+  ~BSplineCurve();
+
+  /**
+   * getControlPoints - Returns the control points without copying them.
+   * A curve built from a ControlNetFile copies its data first.
+   */
+  inline const std::vector<CoreMath::Vector4>& getControlPoints()
+  {
+    detachControlNet();
+    return m_controlPoints;
+  }
+
+  inline double* getKnotVector()
+  {
+    detachControlNet();
+    return m_knotVector;
+  }
+  
+  inline double* getWeights()
+  {
+    detachControlNet();
+    return m_weights;
+  }
+  
+  /**
+   * setControlPoints - Copies the control points. Empty arrays are
+   * ignored.
+   */
+  inline void setControlPoints(const std::vector<CoreMath::Vector4>& controlPoints)
+  {
+    if(!controlPoints.empty()) {
+      detachControlNet();
+      m_controlPoints = controlPoints;
+      updateHomogeneousPoints();
+    }
+  }
+
+  /**
+   * setControlPoints - Takes over the storage of the control points,
+   * without copying them.
+   */
+  inline void setControlPoints(std::vector<CoreMath::Vector4>&& controlPoints)
+  {
+    if(!controlPoints.empty()) {
+      detachControlNet();
+      m_controlPoints = std::move(controlPoints);
+      updateHomogeneousPoints();
+    }
+  }
+
+  inline void setKnotVector(double* knots)
+  {
+    detachControlNet();
+    if(knots != NULL)
+      memcpy(m_knotVector, knots, (m + m_degree + 1) * sizeof(double));
+    m_bezierValid = false;
+  }
+
+  /**
+   * setWeights - Sets the weights of the control points. Weights changed
+   * through getWeights() only take effect after calling
+   * setWeights(getWeights()).
+   * @weights: Array with m + 1 weights.
+   */
+  inline void setWeights(double* weights)
+  {
+    if(weights != NULL) {
+      detachControlNet();
+      if(weights != m_weights)
+        memcpy(m_weights, weights, (m + 1) * sizeof(double));
+      updateHomogeneousPoints();
+    }
+  }
+
+  /**
+   * setParallel - Enables splitting generateCurve among the threads of
+   * ThreadPool::shared(). The generated points are the same, in the same
+   * order, as the serial ones.
+   * @parallel: true to tessellate in parallel.
+   */
+  inline void setParallel(bool parallel)
+  {
+    m_parallel = parallel;
+  }
+
+  /**
+   * setForwardDifferencing - Lets generateCurve tessellate the spans
+   * whose weights are all equal by forward differencing, with m_degree
+   * additions per coordinate and point, instead of evaluating the basis
+   * at every point. Disabled by default, so every span goes through the
+   * basis evaluation (and the cubic kernels selected by setSimdMode);
+   * when enabled, the polynomial spans skip both and differ from the
+   * evaluated points only by rounding.
+   * @enabled: true to forward difference the polynomial spans.
+   */
+  inline void setForwardDifferencing(bool enabled)
+  {
+    m_forwardDifferences = enabled;
+  }
+
+  /**
+   * setSubdivisionLevels - Makes generateCurve output the control polygon
+   * refined a number of times instead of evaluating the curve. Each level
+   * halves every knot interval, so the polygon converges to the curve
+   * and its distance to it shrinks to a quarter per level. Uniform knot
+   * vectors, as built by the constructor, are refined by Lane-Riesenfeld
+   * subdivision (duplication and m_degree rounds of averaging), with
+   * only additions and halvings. Other knot vectors use the Oslo
+   * algorithm. Only the points over the curve domain are kept, and its
+   * end points are added. Ignored while an adaptive tolerance is set.
+   * @levels: Number of levels, 0 to sample the curve in steps of INC.
+   */
+  inline void setSubdivisionLevels(int levels)
+  {
+    m_subdivisionLevels = levels;
+  }
+
+  /**
+   * setAdaptiveTolerance - Chooses how generateCurve samples the curve.
+   * When a limit of the tolerance is set, each knot span is subdivided
+   * until the polyline follows the curve within it, instead of being
+   * sampled in fixed steps of INC.
+   * @tolerance: The limits, in world or screen units. The default
+   * tolerance sets none of them.
+   */
+  inline void setAdaptiveTolerance(const AdaptiveTolerance& tolerance)
+  {
+    m_tolerance = tolerance;
+  }
+
+  inline const AdaptiveTolerance& getAdaptiveTolerance() const
+  {
+    return m_tolerance;
+  }
+
+  /**
+   * setTessellationCache - Makes generateCurve look the tessellation up
+   * in a cache before computing it. Curves with the same degree, knots,
+   * weights, control points and sampling settings share a single copy of
+   * it, which is only copied when the curve is edited or transformed.
+   * @cache: The cache, which must outlive the curve, or NULL to disable
+   * caching (the default).
+   */
+  inline void setTessellationCache(TessellationCache* cache)
+  {
+    m_cache = cache;
+  }
+
+  /**
+   * getRenderPoints - Returns the tessellation made by generateCurve,
+   * without copying it. A pending transform is applied first.
+   */
+  inline const RenderPoints& getRenderPoints()
+  {
+    updateCurve();
+    return currentRenderPoints();
+  }
+
+  /**
+   * moveControlPoint - Moves one control point. Only the degree + 1
+   * knot spans it influences are tessellated again, in place, by
+   * updateCurve.
+   * @i: Index of the control point.
+   * @p: Its new position.
+   */
+  inline void moveControlPoint(int i, const CoreMath::Vector4& p)
+  {
+    moveControlPoints(i, &p, 1);
+  }
+
+  /**
+   * moveControlPoints - Moves a range of control points, as
+   * moveControlPoint.
+   * @first: Index of the first control point of the range.
+   * @points: The new positions.
+   * @count: Number of control points in the range.
+   */
+  void moveControlPoints(int first, const CoreMath::Vector4* points, int count);
+
+  /**
+   * setWeight - Changes the weight of one control point. Only the knot
+   * spans it influences are tessellated again, as for moveControlPoint.
+   * @i: Index of the control point.
+   * @w: The new weight.
+   */
+  inline void setWeight(int i, double w)
+  {
+    setWeights(i, &w, 1);
+  }
+
+  /**
+   * setWeights - Changes the weights of a range of control points, as
+   * setWeight.
+   * @first: Index of the first control point of the range.
+   * @weights: The new weights.
+   * @count: Number of control points in the range.
+   */
+  void setWeights(int first, const double* weights, int count);
+
+  /**
+   * updateCurve - Brings the tessellation up to date after transforms and
+   * control point edits, evaluating again only the knot spans the edits
+   * touched. render and getRenderPoints call it, so it is only needed to
+   * control when the work is done.
+   */
+  void updateCurve();
+
+  inline void setColor(double r, double g, double b, double a)
+  {
+    m_color[0] = r;
+    m_color[1] = g;
+    m_color[2] = b;
+    m_color[3] = a;
+  }
+
+  /**
+   * evaluate - Computes a single point of the curve, without tessellating
+   * it, with de Casteljau's algorithm on the Bezier segment of its span
+   * (see getBezierSegments). No knot is read after the span search.
+   * @u: Parameter. Values outside of the curve domain are extrapolated
+   * from the first or last span.
+   * @returns: The point of the curve at u.
+   */
+  CoreMath::Vector4 evaluate(double u);
+
+  /**
+   * evaluate - Same as above, reusing the span found by a previous call.
+   * Sequential queries should keep passing the same variable.
+   * @u: Parameter.
+   * @spanHint: Span of the previous query, or -1. It is updated with
+   * the span of u.
+   * @returns: The point of the curve at u.
+   */
+  CoreMath::Vector4 evaluate(double u, int& spanHint);
+
+  /**
+   * evaluate - Computes the points of the curve at many parameters in a
+   * single call. The parameters are visited in increasing order, so the
+   * ones falling on the same knot span share the span search. Each point
+   * is evaluated on the Bezier segment of its span, as above.
+   * @params: Contiguous array of parameters, in any order.
+   * @count: Number of parameters.
+   * @out: Caller provided buffer with 3 * count positions. The x, y and
+   * z coordinates of the point at params[k] are written to out[3 * k].
+   */
+  void evaluate(const double* params, int count, double* out);
+
+  /**
+   * getBezierSegments - Returns the curve split in one Bezier curve per
+   * knot span, by inserting the knots of the span until each has
+   * multiplicity m_degree. The segment of span s is made of the
+   * m_degree + 1 homogeneous points starting at (s - m_degree) *
+   * (m_degree + 1), over the parameter t = (u - U[s]) / (U[s + 1] - U[s])
+   * in [0, 1]. Empty spans keep their place with unspecified points. The
+   * conversion is cached until the knots, weights or control points
+   * change, and control point edits only convert the spans they touch.
+   */
+  inline const HomogeneousPoints& getBezierSegments()
+  {
+    updateBezierSegments();
+    return m_bezierPoints;
+  }
+
+  /**
+   * getBoundingBox - Computes a box containing the curve, from the convex
+   * hull of its Bezier segments. It is much tighter than the box of the
+   * control points. Weights must be positive.
+   * @min: Receives the smallest x, y and z.
+   * @max: Receives the largest x, y and z.
+   */
+  void getBoundingBox(CoreMath::Vector4& min, CoreMath::Vector4& max);
+
+  /**
+   * transform - Applies an affine transform to the curve. B-Splines are
+   * affine invariant, so only the control points need to be transformed.
+   * An existing tessellation is transformed as a whole the next time it
+   * is used, and generateCurve does not need to run again.
+   * @matrix: The transform. Its last line is ignored.
+   */
+  void transform(const CoreMath::Matrix4& matrix);
+
+  /**
+   * generateCurve - Tessellates the whole curve. When a tessellation
+   * cache is set (see setTessellationCache) and an identical curve was
+   * tessellated before, its points are shared instead.
+   */
+  void generateCurve();
+
+  /**
+   * generateCurves - Same as calling generateCurve on every curve, for
+   * many curves at once. Curves sampled in steps of INC are grouped by
+   * knot vector and degree. Each group evaluates the blending functions
+   * once per parameter, and each knot span then becomes a small matrix
+   * product of its table of blending functions by the homogeneous control
+   * points of all the curves of the group. Curves in adaptive or
+   * subdivision mode, polynomial curves (all weights equal) with forward
+   * differencing enabled, which it tessellates without the basis, and
+   * groups of a single curve go through generateCurve. Curves with a tessellation
+   * cache are looked up first, and only the misses are tessellated.
+   * @curves: The curves.
+   * @parallel: Whether the knot spans of a group are split among the
+   * threads of ThreadPool::shared().
+   */
+  static void generateCurves(const std::vector<BSplineCurve*>& curves, bool parallel = false);
+
+  /**
+   * render - Draws the control polygon and the tessellation with OpenGL.
+   * Defined in gl/BSplineCurveRender.cpp, which libsplines leaves out.
+   */
+  void render();
+};
+
+#endif /* __BSPLINECURVE_H__ */
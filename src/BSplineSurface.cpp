@@ -8,12 +8,13 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
-#include <GL/glfw.h>
-#include <GL/gl.h>
 
 #include "BSplineSurface.h"
 
-BSplineSurface::BSplineSurface(int _m, int _n, int degreeU, int degreeV) : m(_m), n(_n), m_degreeU(degreeU), m_degreeV(degreeV) {
+#define TILE_ROWS 32
+#define TILE_COLUMNS 128
+
+BSplineSurface::BSplineSurface(int _m, int _n, int degreeU, int degreeV) : m(_m), n(_n), m_degreeU(degreeU), m_degreeV(degreeV), m_renderRows(0), m_renderColumns(0), m_parallel(false), m_cache(NULL) {
     m_knotVectorU = new double[m + m_degreeU + 1];
     m_knotVectorV = new double[n + m_degreeV + 1];
     for(int i = 0; i < m + degreeU + 1; i++)
@@ -21,41 +22,230 @@ BSplineSurface::BSplineSurface(int _m, int _n, int degreeU, int degreeV) : m(_m)
     for(int i = 0; i < n + degreeV + 1; i++)
         m_knotVectorV[i] = (double) i;
     m_weights = (double**) malloc((m + 1) * sizeof(double*));
-    for(int i = 0; i < m + 1; i++)
+    for(int i = 0; i < m + 1; i++) {
         m_weights[i] = (double*) malloc((n + 1) * sizeof(double));
+        for(int j = 0; j < n + 1; j++)
+            m_weights[i][j] = 1.0;
+    }
+    memset(m_color, 0, 4 * sizeof(double));
+}
+
+BSplineSurface::BSplineSurface(const std::shared_ptr<const ControlNetFile>& file, int index) : m_renderRows(0), m_renderColumns(0), m_parallel(false), m_cache(NULL), m_net(file) {
+    const ControlNetFile::SurfaceData& data = file->getSurface(index);
+    m = data.m;
+    n = data.n;
+    m_degreeU = data.degreeU;
+    m_degreeV = data.degreeV;
+    //Os dados mapeados sao somente leitura, detachControlNet os copia antes de qualquer escrita.
+    m_knotVectorU = const_cast<double*>(data.knotsU);
+    m_knotVectorV = const_cast<double*>(data.knotsV);
+    const double* weights = data.points + 3 * (size_t) data.stride;
+    m_weights = (double**) malloc((m + 1) * sizeof(double*));
+    for(int i = 0; i < m + 1; i++)
+        m_weights[i] = const_cast<double*>(weights + (size_t) i * (n + 1));
+    m_homogeneousPoints.setView(data.points, (m + 1) * (n + 1), data.stride);
     memset(m_color, 0, 4 * sizeof(double));
 }
 
 BSplineSurface::~BSplineSurface() {
+    if(!m_net) {
+        for(int i = 0; i < m + 1; i++)
+            free(m_weights[i]);
+        delete[] m_knotVectorU;
+        delete[] m_knotVectorV;
+    }
+    free(m_weights);
     m = n = 0;
     m_degreeU = m_degreeV = 0;
     m_controlPoints.clear();
+    m_homogeneousPoints.clear();
     m_renderPoints.clear();
-    for(int i = 0; i < m + 1; i++)
-        free(m_weights[i]);
-    free(m_weights);
-    delete[] m_knotVectorU;
-    delete[] m_knotVectorV;
+}
+
+void BSplineSurface::detachControlNet() {
+    if(!m_net)
+        return;
+    double* knotsU = new double[m + m_degreeU + 1];
+    double* knotsV = new double[n + m_degreeV + 1];
+    memcpy(knotsU, m_knotVectorU, (m + m_degreeU + 1) * sizeof(double));
+    memcpy(knotsV, m_knotVectorV, (n + m_degreeV + 1) * sizeof(double));
+    m_knotVectorU = knotsU;
+    m_knotVectorV = knotsV;
+    for(int i = 0; i < m + 1; i++) {
+        double* row = (double*) malloc((n + 1) * sizeof(double));
+        memcpy(row, m_weights[i], (n + 1) * sizeof(double));
+        m_weights[i] = row;
+    }
+    m_homogeneousPoints.resize((m + 1) * (n + 1));
+    m_controlPoints.assign(m + 1, std::vector<CoreMath::Vector4>(n + 1));
+    for(int i = 0; i <= m; i++) {
+        for(int j = 0; j <= n; j++) {
+            int k = i * (n + 1) + j;
+            double w = m_homogeneousPoints.w()[k];
+            m_controlPoints[i][j] = CoreMath::Vector4(m_homogeneousPoints.x()[k] / w, m_homogeneousPoints.y()[k] / w, m_homogeneousPoints.z()[k] / w);
+        }
+    }
+    m_net.reset();
+}
+
+bool BSplineSurface::updateHomogeneousPoints() {
+    if((int) m_controlPoints.size() != m + 1)
+        return false;
+    for(int i = 0; i <= m; i++)
+        if((int) m_controlPoints[i].size() != n + 1)
+            return false;
+    m_homogeneousPoints.resize((m + 1) * (n + 1), false);
+    for(int i = 0; i <= m; i++) {
+        for(int j = 0; j <= n; j++) {
+            double w = m_weights[i][j];
+            CoreMath::Vector4& p = m_controlPoints[i][j];
+            m_homogeneousPoints.set(i * (n + 1) + j, p[0] * w, p[1] * w, p[2] * w, w);
+        }
+    }
+    return true;
+}
+
+void BSplineSurface::splitSamples(const std::vector<int>& spans, int maxSize, std::vector<int>& blocks) {
+    blocks.clear();
+    int first = 0;
+    for(int k = 1; k <= (int) spans.size(); k++) {
+        if(k == (int) spans.size() || spans[k] != spans[first] || k - first == maxSize) {
+            blocks.push_back(first);
+            blocks.push_back(k - first);
+            first = k;
+        }
+    }
+}
+
+void BSplineSurface::transform(const CoreMath::Matrix4& matrix) {
+    detachControlNet();
+    for(unsigned int i = 0; i < m_controlPoints.size(); i++)
+        transformControlPoints(matrix, m_controlPoints[i]);
+    if(!currentRenderPoints().empty())
+        m_pendingTransform.append(matrix);
+}
+
+void BSplineSurface::tessellationKey(TessellationKey& key) {
+    key.add('S');
+    key.add(m);
+    key.add(n);
+    key.add(m_degreeU);
+    key.add(m_degreeV);
+    key.add(m_knotVectorU, (m + m_degreeU + 1) * sizeof(double));
+    key.add(m_knotVectorV, (n + m_degreeV + 1) * sizeof(double));
+    for(int c = 0; c < 4; c++)
+        key.add(m_homogeneousPoints.component(c), m_homogeneousPoints.size() * sizeof(double));
+    key.add((double) INC);
+    key.add((int) sizeof(CoreMath::Scalar));
+}
+
+void BSplineSurface::detachRenderPoints() {
+    if(m_cached) {
+        m_renderPoints = m_cached->points;
+        m_cached.reset();
+    }
 }
 
 void BSplineSurface::generateSurface() {
-    if(m_renderPoints.empty() == false)
+    m_pendingTransform.cancel();
+    m_cached.reset();
+    //The net of a mapped surface is already in homogeneous form.
+    if(!m_net && !updateHomogeneousPoints()) {
+        //Sem pontos de controle suficientes nao ha superficie.
         m_renderPoints.clear();
-    // for(int segmentU = 0; segmentU <= m; segmentU++) {
-    //     for(int segmentV = 0; segmentV <= n; segmentV++) {
-    //         for(double u = m_knotVectorU[segmentU]; u <= m_knotVectorU[segmentU + 1]; u += INC) {
-    //             for(double v = m_knotVectorV[segmentV]; u <= m_knotVectorV[segmentV + 1]; v += INC) {
-    //             }
-    //         }
-    //     }
-    // }
-}
-
-void BSplineSurface::render() {
-    //Render the control polygon.
-    glColor4f(0.0f, 1.0f, 1.0f, 0.0f);
-    //Render the curve.
-    glColor4f(m_color[0], m_color[1], m_color[2], m_color[3]);
-    //Render the control points.
-    glColor4f(0.0f, 0.0f, 0.0f, 0.0f);
+        m_renderRows = m_renderColumns = 0;
+        return;
+    }
+    if(m_cache == NULL) {
+        tessellate();
+        return;
+    }
+    TessellationKey key;
+    tessellationKey(key);
+    m_cached = m_cache->find(key);
+    if(m_cached) {
+        m_renderRows = m_cached->rows;
+        m_renderColumns = m_cached->columns;
+        m_renderPoints = RenderPoints();
+        return;
+    }
+    tessellate();
+    Tessellation tessellation;
+    tessellation.points = std::move(m_renderPoints);
+    tessellation.rows = m_renderRows;
+    tessellation.columns = m_renderColumns;
+    m_cached = m_cache->insert(key, std::move(tessellation));
+}
+
+void BSplineSurface::tessellate() {
+    std::vector<double> uParams, vParams;
+    BSplineBasis::tabulateBasis(m_knotVectorU, m, m_degreeU, INC, uParams, m_uSpans, m_uBasis);
+    BSplineBasis::tabulateBasis(m_knotVectorV, n, m_degreeV, INC, vParams, m_vSpans, m_vBasis);
+    m_renderRows = uParams.size();
+    m_renderColumns = vParams.size();
+    m_renderPoints.resize(m_renderRows * m_renderColumns, false);
+
+    //The grid is cut into tiles inside single knot span patches. Dense
+    //knots give many small patches, which the work stealing evens out.
+    std::vector<int> rowBlocks, columnBlocks;
+    splitSamples(m_uSpans, TILE_ROWS, rowBlocks);
+    splitSamples(m_vSpans, TILE_COLUMNS, columnBlocks);
+    std::vector<SurfaceTile> tiles;
+    for(unsigned int r = 0; r < rowBlocks.size(); r += 2) {
+        for(unsigned int c = 0; c < columnBlocks.size(); c += 2) {
+            SurfaceTile tile;
+            tile.firstRow = rowBlocks[r];
+            tile.lastRow = rowBlocks[r] + rowBlocks[r + 1];
+            tile.firstColumn = columnBlocks[c];
+            tile.lastColumn = columnBlocks[c] + columnBlocks[c + 1];
+            tiles.push_back(tile);
+        }
+    }
+
+    if(!m_parallel) {
+        std::vector<double> row(4 * (m_degreeV + 1));
+        for(unsigned int t = 0; t < tiles.size(); t++)
+            generateTile(tiles[t], &row[0]);
+        return;
+    }
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<std::vector<double> > rows(pool.getThreadCount(), std::vector<double>(4 * (m_degreeV + 1)));
+    pool.parallelFor(tiles.size(), [this, &tiles, &rows](int t, int thread) {
+        generateTile(tiles[t], &rows[thread][0]);
+    });
+}
+
+void BSplineSurface::generateTile(const SurfaceTile& tile, double* row) {
+    //For every u row the U blending functions collapse the patch into one
+    //homogeneous curve over its V control points, which every v column of
+    //the row then evaluates with its own blending functions.
+    int i0 = m_uSpans[tile.firstRow] - m_degreeU;
+    int j0 = m_vSpans[tile.firstColumn] - m_degreeV;
+    for(int r = tile.firstRow; r < tile.lastRow; r++) {
+        const double* Nu = &m_uBasis[r * (m_degreeU + 1)];
+        for(int k = 0; k < 4; k++) {
+            const double* P = m_homogeneousPoints.component(k) + i0 * (n + 1) + j0;
+            for(int b = 0; b <= m_degreeV; b++) {
+                double h = 0.0;
+                for(int a = 0; a <= m_degreeU; a++)
+                    h += Nu[a] * P[a * (n + 1) + b];
+                row[4 * b + k] = h;
+            }
+        }
+        int offset = r * m_renderColumns;
+        CoreMath::Scalar* ox = m_renderPoints.x() + offset;
+        CoreMath::Scalar* oy = m_renderPoints.y() + offset;
+        CoreMath::Scalar* oz = m_renderPoints.z() + offset;
+        for(int c = tile.firstColumn; c < tile.lastColumn; c++) {
+            const double* Nv = &m_vBasis[c * (m_degreeV + 1)];
+            double h[4] = {0.0, 0.0, 0.0, 0.0};
+            for(int b = 0; b <= m_degreeV; b++)
+                for(int k = 0; k < 4; k++)
+                    h[k] += Nv[b] * row[4 * b + k];
+            double iw = 1.0 / h[3];
+            ox[c] = h[0] * iw;
+            oy[c] = h[1] * iw;
+            oz[c] = h[2] * iw;
+        }
+    }
 }
@@ -10,10 +10,18 @@
 
 #include <vector>
 #include <cstring>
+#include <utility>
+#include <memory>
 #include <CoreMath/Vector4.hpp>
 
 #include "main.h"
 #include "BSplineCurve.h"
+#include "BSplineBasis.h"
+#include "ThreadPool.h"
+#include "PointArray.h"
+#include "PointTransform.h"
+#include "TessellationCache.h"
+#include "ControlNetFile.h"
 
 class BSplineSurface {
 private:
@@ -22,55 +30,137 @@ private:
     double* m_knotVectorU, *m_knotVectorV;
     double** m_weights;
     std::vector<std::vector<CoreMath::Vector4> > m_controlPoints;
-    std::vector<CoreMath::Vector4> m_renderPoints;
+    HomogeneousPoints m_homogeneousPoints;
+    RenderPoints m_renderPoints;
+    PendingTransform m_pendingTransform;
+    int m_renderRows, m_renderColumns;
+    std::vector<int> m_uSpans, m_vSpans;
+    std::vector<double> m_uBasis, m_vBasis;
+    bool m_parallel;
+    TessellationCache* m_cache;
+    std::shared_ptr<const Tessellation> m_cached;
+    std::shared_ptr<const ControlNetFile> m_net;
     double m_color[4];
 
     /**
-     * B - B-Spline blending function.
-     * @returns: The Influence of the control point given the paramenter.
-     * @i: i-th control point.
-     * @n: Degree of the curve.
-     * @u: Parameter.
-     * @knotVector: The knot vector to be used.
+     * detachControlNet - Copies the knots, weights and control net of a
+     * surface built from a ControlNetFile to storage of its own. Does
+     * nothing for other surfaces.
      */
-    double B(int i/*i-th patch*/, int n/*degree*/, double u/*paramater*/, double* knotVector) {
-        if(n == 0) {
-            if(u >= knotVector[i] && u < knotVector[i + 1])
-                return 1.0;
-            return 0.0;
-        }
-        double f = 0.0;
-        double g = 0.0;
-        if(knotVector[i + n] - knotVector[i] != 0)
-            f = (u - knotVector[i]) / (knotVector[i + n] - knotVector[i]);
-        if(knotVector[i + n + 1] - knotVector[i + 1] != 0)
-            g = (knotVector[i + n + 1] - u) / (knotVector[i + n + 1] - knotVector[i + 1]);
-        return f * B(i, n - 1, u, knotVector) + g * B(i + 1, n - 1, u, knotVector);
+    void detachControlNet();
+
+    /**
+     * SurfaceTile - A rectangle of the sample grid lying inside a single
+     * knot span patch, small enough for its points to stay in cache.
+     */
+    struct SurfaceTile {
+        int firstRow, lastRow;
+        int firstColumn, lastColumn;
+    };
+
+    /**
+     * updateHomogeneousPoints - Rebuilds m_homogeneousPoints, the control
+     * net premultiplied by the weights, row after row: point (i, j) is at
+     * index i * (n + 1) + j. Returns false, leaving it untouched, when
+     * the control net is not (m + 1) x (n + 1) points.
+     */
+    bool updateHomogeneousPoints();
+
+    /**
+     * splitSamples - Splits the samples of one direction into blocks that
+     * never cross a knot span.
+     * @spans: The knot span of each sample.
+     * @maxSize: The largest block size.
+     * @blocks: Receives the first sample of each block, followed by the
+     * number of samples.
+     */
+    void splitSamples(const std::vector<int>& spans, int maxSize, std::vector<int>& blocks);
+
+    /**
+     * generateTile - Evaluates the points of a tile into m_renderPoints.
+     * @tile: The tile.
+     * @row: Scratch buffer with 4 * (m_degreeV + 1) positions.
+     */
+    void generateTile(const SurfaceTile& tile, double* row);
+
+    /**
+     * tessellate - Evaluates the whole grid into m_renderPoints, over the
+     * current m_homogeneousPoints.
+     */
+    void tessellate();
+
+    /**
+     * tessellationKey - Builds the key of the grid in a TessellationCache.
+     * @key: The key to be filled.
+     */
+    void tessellationKey(TessellationKey& key);
+
+    /**
+     * currentRenderPoints - Returns the grid in use: the cached one shared
+     * with other surfaces or m_renderPoints.
+     */
+    inline const RenderPoints& currentRenderPoints() const {
+        return m_cached ? m_cached->points : m_renderPoints;
     }
+
+    /**
+     * detachRenderPoints - Copies a cached grid to m_renderPoints before
+     * it is transformed.
+     */
+    void detachRenderPoints();
 public:
     BSplineSurface(int _m, int _n, int degreeU, int degreeV);
+
+    /**
+     * BSplineSurface - Builds a surface over the data of a memory mapped
+     * ControlNetFile, without copying it. See the BSplineCurve
+     * constructor taking a ControlNetFile.
+     * @file: The open file, kept mapped while the surface uses it.
+     * @index: Index of the surface in the file.
+     */
+    BSplineSurface(const std::shared_ptr<const ControlNetFile>& file, int index);
     ~BSplineSurface();
 
-    inline std::vector<std::vector<CoreMath::Vector4> > getControlPoints() {
+    /**
+     * getControlPoints - Returns the control net, by rows, without
+     * copying it. A surface built from a ControlNetFile copies its data
+     * first.
+     */
+    inline const std::vector<std::vector<CoreMath::Vector4> >& getControlPoints() {
+        detachControlNet();
         return m_controlPoints;
     }
 
     inline double* getKnotVector(int index) {
+        detachControlNet();
         if(index == 0)
             return m_knotVectorU;
         return m_knotVectorV;
     }
 
     inline double** getWeights() {
+        detachControlNet();
         return m_weights;
     }
 
-    inline void setControlPoints(std::vector<std::vector<CoreMath::Vector4> > controlPoints) {
+    inline void setControlPoints(const std::vector<std::vector<CoreMath::Vector4> >& controlPoints) {
+        detachControlNet();
         if(!controlPoints.empty())
             m_controlPoints = controlPoints;
     }
 
+    /**
+     * setControlPoints - Takes over the storage of the control net,
+     * without copying it.
+     */
+    inline void setControlPoints(std::vector<std::vector<CoreMath::Vector4> >&& controlPoints) {
+        detachControlNet();
+        if(!controlPoints.empty())
+            m_controlPoints = std::move(controlPoints);
+    }
+
     inline void setKnotVector(int index, double* knots) {
+        detachControlNet();
         if(knots != NULL) {
             if(index == 0)
                 memcpy(m_knotVectorU, knots, (m + m_degreeU + 1) * sizeof(double));
@@ -80,8 +170,58 @@ public:
     }
 
     inline void setWeights(double** weights) {
+        detachControlNet();
         if(weights != NULL)
-            memcpy(m_weights, weights, (m + 1) * (n + 1) * sizeof(double));
+            for(int i = 0; i < m + 1; i++)
+                memcpy(m_weights[i], weights[i], (n + 1) * sizeof(double));
+    }
+
+    /**
+     * getRenderRows - Returns the number of u samples of the generated
+     * grid. The point of row i and column j is m_renderPoints[i * columns + j].
+     */
+    inline int getRenderRows() {
+        return m_renderRows;
+    }
+
+    /**
+     * getRenderColumns - Returns the number of v samples of the generated
+     * grid.
+     */
+    inline int getRenderColumns() {
+        return m_renderColumns;
+    }
+
+    /**
+     * setParallel - Enables splitting generateSurface among the threads of
+     * ThreadPool::shared(). The generated grid is the same as the serial
+     * one.
+     * @parallel: true to tessellate in parallel.
+     */
+    inline void setParallel(bool parallel) {
+        m_parallel = parallel;
+    }
+
+    /**
+     * setTessellationCache - Makes generateSurface share the grid of an
+     * identical surface (same degrees, knots, weights and control net)
+     * found in a cache instead of evaluating it again.
+     * @cache: The cache, which must outlive the surface, or NULL to
+     * disable caching (the default).
+     */
+    inline void setTessellationCache(TessellationCache* cache) {
+        m_cache = cache;
+    }
+
+    /**
+     * getRenderPoints - Returns the grid made by generateSurface, row
+     * by row, without copying it. A pending transform is applied first.
+     */
+    inline const RenderPoints& getRenderPoints() {
+        if(m_pendingTransform.isPending())
+            detachRenderPoints();
+        m_pendingTransform.apply(m_renderPoints, m_parallel);
+        return currentRenderPoints();
     }
 
     inline void setColor(double r, double g, double b, double a) {
@@ -91,7 +231,20 @@ public:
         m_color[3] = a;
     }
 
+    /**
+     * transform - Applies an affine transform to the surface through its
+     * control points. An existing tessellation is transformed as a whole
+     * the next time it is used, without calling generateSurface again.
+     * @matrix: The transform. Its last line is ignored.
+     */
+    void transform(const CoreMath::Matrix4& matrix);
+
     void generateSurface();
+
+    /**
+     * render - Draws the surface with OpenGL. Defined in
+     * gl/BSplineSurfaceRender.cpp, which libsplines leaves out.
+     */
     void render();
 };
 
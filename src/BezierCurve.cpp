@@ -7,12 +7,29 @@
 
 #include <iostream>
 #include <cstring>
-#include <GL/glfw.h>
-#include <GL/gl.h>
 
 #include "BezierCurve.h"
+#include "SimdKernels.h"
+#include "ForwardDifference.h"
 
-BezierCurve::BezierCurve(int degree) : m_degree(degree) {}
+/**
+ * Highest degree tessellated by forward differencing. The power basis
+ * coefficients grow with the binomials of the degree and their round off
+ * is amplified along the differences, so beyond it the points drift away
+ * from the curve and m_method is used instead.
+ */
+#define FORWARD_DIFFERENCE_MAX_DEGREE 5
+
+BezierCurve::BezierCurve(int degree) : m_degree(degree), m_method(BEZIER_BERNSTEIN), m_forwardDifferences(false)
+{
+  //Binomial coefficients of the degree, row by row of Pascal's triangle,
+  //so no factorial is ever computed.
+  m_binomial.assign(m_degree + 1, 0.0);
+  m_binomial[0] = 1.0;
+  for(int n = 1; n <= m_degree; n++)
+    for(int i = n; i > 0; i--)
+      m_binomial[i] += m_binomial[i - 1];
+}
 
 BezierCurve::~BezierCurve()
 {
@@ -21,27 +38,118 @@ BezierCurve::~BezierCurve()
   m_renderPoints.clear();
 }
 
+void BezierCurve::transform(const CoreMath::Matrix4& matrix)
+{
+  transformControlPoints(matrix, m_controlPoints);
+  if(!m_renderPoints.empty())
+    m_pendingTransform.append(matrix);
+}
+
 void BezierCurve::generateCurve()
 {
-  for(double u = 0.0; u <= 1.0; u += INC) {
-    double acc_x = 0.0;
-    double acc_y = 0.0;
-    for(int i = 0; i <= DEGREE; i++) {
-      acc_x += m_controlPoints[i][0] * B(i, DEGREE, u);
-      acc_y += m_controlPoints[i][1] * B(i, DEGREE, u);
-    }
-    m_renderPoints.push_back(CoreMath::Vector4(acc_x, acc_y, 0.0));
+  m_pendingTransform.cancel();
+  if(m_tolerance.isEnabled()) {
+    std::vector<double> points(3 * (m_degree + 1));
+    std::vector<double> scratch(3 * (m_degree + 1));
+    for(int i = 0; i <= m_degree; i++)
+      for(int c = 0; c < 3; c++)
+        points[3 * i + c] = m_controlPoints[i][c];
+    std::vector<double> xyz;
+    tessellateAdaptive([this, &points, &scratch](double u, double* p) {
+      evaluatePoint(u, &points[0], &scratch[0], p);
+    }, 0.0, 1.0, m_tolerance, xyz);
+    m_renderPoints.resize(xyz.size() / 3, false);
+    for(int k = 0; k < m_renderPoints.size(); k++)
+      m_renderPoints.set(k, xyz[3 * k], xyz[3 * k + 1], xyz[3 * k + 2]);
+    return;
   }
+  std::vector<double> params;
+  for(double u = 0.0; u <= 1.0; u += INC)
+    params.push_back(u);
+  m_renderPoints.resize(params.size(), false);
+  if(m_forwardDifferences && m_degree <= FORWARD_DIFFERENCE_MAX_DEGREE) {
+    std::vector<double> points(3 * (m_degree + 1));
+    std::vector<double> coefficients(3 * (m_degree + 1));
+    for(int i = 0; i <= m_degree; i++)
+      for(int c = 0; c < 3; c++)
+        points[3 * i + c] = m_controlPoints[i][c];
+    bezierPowerBasis(&points[0], m_degree, &coefficients[0]);
+    std::vector<double> x(params.size()), y(params.size()), z(params.size());
+    forwardDifferences(&coefficients[0], m_degree, INC, params.size(), &x[0], &y[0], &z[0]);
+    for(unsigned int k = 0; k < params.size(); k++)
+      m_renderPoints.set(k, x[k], y[k], z[k]);
+    return;
+  }
+  if(m_degree == 3 && m_method == BEZIER_BERNSTEIN) {
+    double points[12];
+    for(int i = 0; i <= 3; i++)
+      for(int c = 0; c < 3; c++)
+        points[3 * i + c] = m_controlPoints[i][c];
+    std::vector<double> x(params.size()), y(params.size()), z(params.size());
+    evaluateCubicBezier(points, &params[0], params.size(), &x[0], &y[0], &z[0]);
+    for(unsigned int k = 0; k < params.size(); k++)
+      m_renderPoints.set(k, x[k], y[k], z[k]);
+    return;
+  }
+  std::vector<double> xyz(3 * params.size());
+  evaluate(&params[0], params.size(), &xyz[0]);
+  for(unsigned int k = 0; k < params.size(); k++)
+    m_renderPoints.set(k, xyz[3 * k], xyz[3 * k + 1], xyz[3 * k + 2]);
+}
+
+void BezierCurve::evaluate(const double* params, int count, double* out)
+{
+  std::vector<double> points(3 * (m_degree + 1));
+  std::vector<double> scratch(3 * (m_degree + 1));
+  for(int i = 0; i <= m_degree; i++)
+    for(int c = 0; c < 3; c++)
+      points[3 * i + c] = m_controlPoints[i][c];
+  for(int k = 0; k < count; k++)
+    evaluatePoint(params[k], &points[0], &scratch[0], out + 3 * k);
 }
 
-void BezierCurve::render()
+void BezierCurve::evaluatePoint(double u, const double* points, double* scratch, double* out)
 {
-  //Render the curve.
-  glColor4f(0.5, 0.0, 0.7, 0.0);
-  glBegin(GL_LINES);
-  for(unsigned int i = 1; i < m_renderPoints.size(); i++) {
-    glVertex2f(m_renderPoints[i][0], m_renderPoints[i][1]);
-    glVertex2f(m_renderPoints[i - 1][0], m_renderPoints[i - 1][1]);
+  double s = 1.0 - u;
+  switch(m_method) {
+  case BEZIER_BERNSTEIN: {
+    //scratch[i] = (1 - u)^(n - i), then u^i grows along the sum.
+    scratch[m_degree] = 1.0;
+    for(int i = m_degree - 1; i >= 0; i--)
+      scratch[i] = scratch[i + 1] * s;
+    double ui = 1.0;
+    out[0] = out[1] = out[2] = 0.0;
+    for(int i = 0; i <= m_degree; i++) {
+      double b = m_binomial[i] * ui * scratch[i];
+      out[0] += b * points[3 * i];
+      out[1] += b * points[3 * i + 1];
+      out[2] += b * points[3 * i + 2];
+      ui *= u;
+    }
+    break;
+  }
+  case BEZIER_HORNER: {
+    //((C0 P0 s + C1 P1 u) s + C2 P2 u^2) s + ... + Cn Pn u^n
+    double ui = 1.0;
+    for(int c = 0; c < 3; c++)
+      out[c] = points[c];
+    for(int i = 1; i <= m_degree; i++) {
+      ui *= u;
+      double b = m_binomial[i] * ui;
+      for(int c = 0; c < 3; c++)
+        out[c] = out[c] * s + b * points[3 * i + c];
+    }
+    break;
+  }
+  case BEZIER_DE_CASTELJAU:
+    for(int i = 0; i < 3 * (m_degree + 1); i++)
+      scratch[i] = points[i];
+    for(int r = 1; r <= m_degree; r++)
+      for(int i = 0; i <= m_degree - r; i++)
+        for(int c = 0; c < 3; c++)
+          scratch[3 * i + c] = s * scratch[3 * i + c] + u * scratch[3 * (i + 1) + c];
+    for(int c = 0; c < 3; c++)
+      out[c] = scratch[c];
+    break;
   }
-  glEnd();
 }
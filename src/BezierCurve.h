@@ -10,48 +10,156 @@
 
 #include <vector>
 #include <cmath>
+#include <utility>
 #include <CoreMath/Vector4.hpp>
 
 #include "main.h"
+#include "PointArray.h"
+#include "PointTransform.h"
+#include "AdaptiveTessellation.h"
+
+/**
+ * BezierMethod - Ways of evaluating a Bezier curve.
+ * BEZIER_BERNSTEIN: Sums the Bernstein polynomials, built from the cached
+ * binomial row and incremental powers of u and 1 - u. O(degree).
+ * BEZIER_HORNER: Nested (Horner like) form of the Bernstein sum. O(degree)
+ * with the fewest operations, but the least stable for high degrees.
+ * BEZIER_DE_CASTELJAU: Repeated linear interpolation of the control
+ * points. O(degree^2), the most stable.
+ */
+enum BezierMethod {
+  BEZIER_BERNSTEIN,
+  BEZIER_HORNER,
+  BEZIER_DE_CASTELJAU
+};
 
 class BezierCurve
 {
 private:
   int m_degree;
+  BezierMethod m_method;
+  bool m_forwardDifferences;
+  std::vector<double> m_binomial;
   std::vector<CoreMath::Vector4> m_controlPoints;
-  std::vector<CoreMath::Vector4> m_renderPoints;
+  RenderPoints m_renderPoints;
+  PendingTransform m_pendingTransform;
+  AdaptiveTolerance m_tolerance;
+
+  /**
+   * evaluatePoint - Computes a point of the curve with m_method.
+   * @u: Parameter.
+   * @points: The control points as (x, y, z) triples.
+   * @scratch: Buffer with 3 * (m_degree + 1) positions.
+   * @out: Receives the x, y and z coordinates of the point.
+   */
+  void evaluatePoint(double u, const double* points, double* scratch, double* out);
+public:
+  BezierCurve(int degree);
+  ~BezierCurve();
 
-  double fatorial(int n)
+  /**
+   * setMethod - Selects how the curve is evaluated. The default is
+   * BEZIER_BERNSTEIN. generateCurve uses it for every point unless
+   * setForwardDifferencing was enabled and the degree is at most 5.
+   * @method: The evaluation method.
+   */
+  inline void setMethod(BezierMethod method)
   {
-    if(n <= 1)
-      return 1;
-    return n * fatorial(n - 1);
+    m_method = method;
   }
 
-  double C(int n, int i)
+  /**
+   * setForwardDifferencing - Lets generateCurve convert the curve to the
+   * power basis and tessellate it by forward differencing, with m_degree
+   * additions per coordinate and point, instead of evaluating it with
+   * m_method. Disabled by default, so the method given to setMethod is
+   * used; when enabled it still only applies to degrees 1 to 5, since the
+   * power basis loses too much precision above them.
+   * @enabled: true to forward difference curves of degree 1 to 5.
+   */
+  inline void setForwardDifferencing(bool enabled)
   {
-    return fatorial(n) / (fatorial(i) * fatorial(n - i));
+    m_forwardDifferences = enabled;
   }
 
-  double B(int i, int n, double u)
+  /**
+   * setAdaptiveTolerance - Chooses how generateCurve samples the curve.
+   * When a limit of the tolerance is set, [0, 1] is subdivided until the
+   * polyline follows the curve within it, instead of being sampled in
+   * fixed steps of INC.
+   * @tolerance: The limits. The default tolerance sets none of them.
+   */
+  inline void setAdaptiveTolerance(const AdaptiveTolerance& tolerance)
   {
-    return C(n, i) * pow(u, i) * pow(1 - u, n - i);
+    m_tolerance = tolerance;
+  }
+
+  inline const AdaptiveTolerance& getAdaptiveTolerance() const
+  {
+    return m_tolerance;
   }
-public:
-  BezierCurve(int degree);
-  ~BezierCurve();
 
-  std::vector<CoreMath::Vector4> getContolPoints()
+  /**
+   * getControlPoints - Returns the control points without copying them.
+   */
+  inline const std::vector<CoreMath::Vector4>& getControlPoints() const
   {
     return m_controlPoints;
   }
 
-  inline void setControlPoints(std::vector<CoreMath::Vector4> controlPoints)
+  inline const std::vector<CoreMath::Vector4>& getContolPoints() const
+  {
+    return m_controlPoints;
+  }
+
+  inline void setControlPoints(const std::vector<CoreMath::Vector4>& controlPoints)
   {
     m_controlPoints = controlPoints;
   }
 
+  /**
+   * setControlPoints - Takes over the storage of the control points,
+   * without copying them.
+   */
+  inline void setControlPoints(std::vector<CoreMath::Vector4>&& controlPoints)
+  {
+    m_controlPoints = std::move(controlPoints);
+  }
+
+  /**
+   * getRenderPoints - Returns the tessellation made by generateCurve,
+   * without copying it. A pending transform is applied first.
+   */
+  inline const RenderPoints& getRenderPoints()
+  {
+    m_pendingTransform.apply(m_renderPoints, false);
+    return m_renderPoints;
+  }
+
+  /**
+   * evaluate - Computes the points of the curve at many parameters in a
+   * single call, using the method given to setMethod.
+   * @params: Contiguous array of parameters in [0, 1].
+   * @count: Number of parameters.
+   * @out: Caller provided buffer with 3 * count positions. The x, y and
+   * z coordinates of the point at params[k] are written to out[3 * k].
+   */
+  void evaluate(const double* params, int count, double* out);
+
+  /**
+   * transform - Applies an affine transform to the curve through its
+   * control points. An existing tessellation is transformed as a whole
+   * the next time it is used, without calling generateCurve again.
+   * @matrix: The transform. Its last line is ignored.
+   */
+  void transform(const CoreMath::Matrix4& matrix);
+
   void generateCurve();
+
+  /**
+   * render - Draws the tessellation with OpenGL. Defined in
+   * gl/BezierCurveRender.cpp, which libsplines leaves out.
+   */
   void render();
 };
 
@@ -0,0 +1,265 @@
+/**
+ * File: ControlNetFile.cpp
+ * Author: agent
+ * Implementation of the ControlNetFile and ControlNetWriter classes.
+ * File created on 18 October 2026, 07:10
+ */
+
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+#include "ControlNetFile.h"
+
+#define CONTROLNET_VERSION 1
+#define CONTROLNET_BLOCK 4096
+
+/**
+ * The file starts with a NetHeader, followed by one NetRecord per object.
+ * Each record is followed by its knots (the u knots, then the v knots of a
+ * surface), padding up to a multiple of 32 bytes and the x * w, y * w,
+ * z * w and w arrays, stride doubles each. The stride is the number of
+ * control points rounded up to a multiple of 4, so every array is 32 byte
+ * aligned. Numbers are stored in the byte order of the machine.
+ */
+struct NetHeader {
+  char magic[8];
+  unsigned int version;
+  unsigned int reserved;
+  unsigned long long curveCount;
+  unsigned long long surfaceCount;
+  unsigned long long fileSize;
+};
+
+struct NetRecord {
+  int surface;
+  int degreeU, degreeV;
+  int m, n;
+  int stride;
+};
+
+static const char CONTROLNET_MAGIC[8] = {'S', 'P', 'L', 'N', 'E', 'T', '\n', 0};
+
+static inline unsigned long long alignedSize(unsigned long long size)
+{
+  return (size + 31) & ~31ULL;
+}
+
+static inline int pointStride(long long count)
+{
+  return (int) ((count + 3) & ~3LL);
+}
+
+/**
+ * validShape - Checks the sizes of an object. Curves have n and degreeV
+ * 0. The knot and point counts, including the stride, must fit an int,
+ * since the curves and surfaces index their nets with them.
+ */
+static bool validShape(bool surface, int m, int n, int degreeU, int degreeV)
+{
+  if(degreeU < 1 || m < degreeU || n < degreeV || (surface ? degreeV < 1 : n != 0 || degreeV != 0))
+    return false;
+  long long count = ((long long) m + 1) * ((long long) n + 1);
+  return (long long) m + degreeU + 1 <= INT_MAX && (long long) n + degreeV + 1 <= INT_MAX && count <= INT_MAX - 3;
+}
+
+/**
+ * validKnots - Checks that a knot vector is finite and nondecreasing.
+ */
+static bool validKnots(const double* knots, int count)
+{
+  for(int i = 0; i < count; i++)
+    if(!std::isfinite(knots[i]) || (i > 0 && knots[i] < knots[i - 1]))
+      return false;
+  return true;
+}
+
+/**
+ * validPoints - Checks that the control points, premultiplied by their
+ * weights (1 when w is NULL), are finite.
+ */
+static bool validPoints(int count, const double* x, const double* y, const double* z, const double* w)
+{
+  for(int i = 0; i < count; i++) {
+    double weight = w != NULL ? w[i] : 1.0;
+    if(!std::isfinite(weight) || !std::isfinite(x[i] * weight) || !std::isfinite(y[i] * weight) || !std::isfinite(z[i] * weight))
+      return false;
+  }
+  return true;
+}
+
+bool ControlNetFile::open(const char* path)
+{
+  close();
+  if(!m_file.open(path))
+    return false;
+  const char* data = m_file.data();
+  unsigned long long size = m_file.size();
+  NetHeader header;
+  if(size < sizeof(header)) {
+    close();
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if(memcmp(header.magic, CONTROLNET_MAGIC, sizeof(header.magic)) != 0 || header.version != CONTROLNET_VERSION || header.fileSize != size) {
+    close();
+    return false;
+  }
+
+  unsigned long long position = sizeof(header);
+  for(unsigned long long e = 0; e < header.curveCount + header.surfaceCount; e++) {
+    NetRecord record;
+    if(size - position < sizeof(record)) {
+      close();
+      return false;
+    }
+    memcpy(&record, data + position, sizeof(record));
+    if(!record.surface)
+      record.n = record.degreeV = 0;
+    if(!validShape(record.surface != 0, record.m, record.n, record.degreeU, record.degreeV)) {
+      close();
+      return false;
+    }
+    int count = (record.m + 1) * (record.n + 1);
+    if(record.stride != pointStride(count)) {
+      close();
+      return false;
+    }
+    int knotsU = record.m + record.degreeU + 1;
+    int knotsV = record.surface ? record.n + record.degreeV + 1 : 0;
+    unsigned long long knots = (unsigned long long) knotsU + knotsV;
+    unsigned long long start = alignedSize(position + sizeof(record) + knots * sizeof(double));
+    unsigned long long end = start + 4ULL * record.stride * sizeof(double);
+    if(end > size) {
+      close();
+      return false;
+    }
+    //O arquivo nao e confiavel: nos e pontos sao verificados uma vez aqui.
+    const double* knotVector = (const double*) (data + position + sizeof(record));
+    const double* points = (const double*) (data + start);
+    if(!validKnots(knotVector, knotsU) || !validKnots(knotVector + knotsU, knotsV) ||
+       !validPoints(count, points, points + record.stride, points + 2 * (size_t) record.stride, points + 3 * (size_t) record.stride)) {
+      close();
+      return false;
+    }
+    if(record.surface) {
+      SurfaceData surface = {record.m, record.n, record.degreeU, record.degreeV, knotVector, knotVector + knotsU, points, record.stride};
+      m_surfaces.push_back(surface);
+    }
+    else {
+      CurveData curve = {record.m, record.degreeU, knotVector, points, record.stride};
+      m_curves.push_back(curve);
+    }
+    position = end;
+  }
+  if((unsigned long long) m_curves.size() != header.curveCount) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void ControlNetFile::close()
+{
+  m_curves.clear();
+  m_surfaces.clear();
+  m_file.close();
+}
+
+bool ControlNetWriter::open(const char* path)
+{
+  close();
+  m_file = fopen(path, "wb");
+  if(m_file == NULL)
+    return false;
+  m_path = path;
+  m_position = 0;
+  m_curveCount = m_surfaceCount = 0;
+  m_ok = true;
+  NetHeader header;
+  memset(&header, 0, sizeof(header)); //Reescrito por close.
+  writeBlock(&header, sizeof(header));
+  return m_ok;
+}
+
+void ControlNetWriter::writeBlock(const void* data, size_t size)
+{
+  if(m_ok && size > 0 && fwrite(data, 1, size, m_file) != size)
+    m_ok = false;
+  m_position += size;
+}
+
+void ControlNetWriter::align()
+{
+  static const char zeros[32] = {0};
+  writeBlock(zeros, alignedSize(m_position) - m_position);
+}
+
+void ControlNetWriter::writePoints(int count, const double* x, const double* y, const double* z, const double* w)
+{
+  const double* coordinates[3] = {x, y, z};
+  std::vector<double> block(CONTROLNET_BLOCK);
+  for(int c = 0; c < 4; c++) {
+    for(int first = 0; first < count; first += CONTROLNET_BLOCK) {
+      int size = std::min(CONTROLNET_BLOCK, count - first);
+      for(int i = 0; i < size; i++) {
+        double weight = w != NULL ? w[first + i] : 1.0;
+        block[i] = c < 3 ? coordinates[c][first + i] * weight : weight;
+      }
+      writeBlock(&block[0], size * sizeof(double));
+    }
+    static const double zeros[4] = {0.0, 0.0, 0.0, 0.0};
+    writeBlock(zeros, (pointStride(count) - count) * sizeof(double));
+  }
+}
+
+bool ControlNetWriter::addCurve(int m, int degree, const double* knots, const double* x, const double* y, const double* z, const double* w)
+{
+  if(m_file == NULL || !validShape(false, m, 0, degree, 0) || !validKnots(knots, m + degree + 1) || !validPoints(m + 1, x, y, z, w))
+    return false;
+  NetRecord record = {0, degree, 0, m, 0, pointStride(m + 1)};
+  writeBlock(&record, sizeof(record));
+  writeBlock(knots, (m + degree + 1) * sizeof(double));
+  align();
+  writePoints(m + 1, x, y, z, w);
+  m_curveCount++;
+  return true;
+}
+
+bool ControlNetWriter::addSurface(int m, int n, int degreeU, int degreeV, const double* knotsU, const double* knotsV,
+                                  const double* x, const double* y, const double* z, const double* w)
+{
+  if(m_file == NULL || !validShape(true, m, n, degreeU, degreeV) || !validKnots(knotsU, m + degreeU + 1) || !validKnots(knotsV, n + degreeV + 1) ||
+     !validPoints((m + 1) * (n + 1), x, y, z, w))
+    return false;
+  NetRecord record = {1, degreeU, degreeV, m, n, pointStride((long long) (m + 1) * (n + 1))};
+  writeBlock(&record, sizeof(record));
+  writeBlock(knotsU, (m + degreeU + 1) * sizeof(double));
+  writeBlock(knotsV, (n + degreeV + 1) * sizeof(double));
+  align();
+  writePoints((m + 1) * (n + 1), x, y, z, w);
+  m_surfaceCount++;
+  return true;
+}
+
+bool ControlNetWriter::close()
+{
+  if(m_file == NULL)
+    return false;
+  NetHeader header;
+  memcpy(header.magic, CONTROLNET_MAGIC, sizeof(header.magic));
+  header.version = CONTROLNET_VERSION;
+  header.reserved = 0;
+  header.curveCount = m_curveCount;
+  header.surfaceCount = m_surfaceCount;
+  header.fileSize = m_position;
+  if(m_ok && (fseek(m_file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, m_file) != 1))
+    m_ok = false;
+  if(fclose(m_file) != 0)
+    m_ok = false;
+  m_file = NULL;
+  if(!m_ok)
+    remove(m_path.c_str());
+  return m_ok;
+}
@@ -0,0 +1,172 @@
+/**
+ * File: ControlNetFile.h
+ * Author: agent
+ * Definition of the ControlNetFile and ControlNetWriter classes, a binary
+ * format for large control nets which curves and surfaces evaluate in
+ * place, from a memory mapping.
+ * File created on 18 October 2026, 07:10
+ */
+
+#ifndef __CONTROLNETFILE_H__
+#define __CONTROLNETFILE_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/**
+ * ControlNetFile - A memory mapped file of curve and surface definitions.
+ * The control points are stored premultiplied by their weights, as
+ * (x * w, y * w, z * w, w) in double precision, one 32 byte aligned
+ * array per component: the layout of HomogeneousPoints. The constructors
+ * of BSplineCurve and BSplineSurface taking a ControlNetFile evaluate
+ * straight over these arrays and the stored knots, so nothing is copied.
+ */
+class ControlNetFile {
+public:
+  /**
+   * CurveData - A curve of the file, as pointers into the mapping.
+   * Component c of control point i is points[c * stride + i].
+   */
+  struct CurveData {
+    int m;
+    int degree;
+    const double* knots;
+    const double* points;
+    int stride;
+  };
+
+  /**
+   * SurfaceData - A surface of the file. Control point (i, j) is at index
+   * i * (n + 1) + j of each component.
+   */
+  struct SurfaceData {
+    int m, n;
+    int degreeU, degreeV;
+    const double* knotsU;
+    const double* knotsV;
+    const double* points;
+    int stride;
+  };
+private:
+  MappedFile m_file;
+  std::vector<CurveData> m_curves;
+  std::vector<SurfaceData> m_surfaces;
+
+  ControlNetFile(const ControlNetFile&);
+  ControlNetFile& operator =(const ControlNetFile&);
+public:
+  ControlNetFile() {}
+
+  /**
+   * open - Maps a file written by ControlNetWriter and indexes its
+   * objects, closing the current one first.
+   * @path: The file.
+   * @returns: false if the file could not be mapped, is truncated, was
+   * written by another version or holds an invalid object: sizes whose
+   * counts overflow an int, decreasing knots, or NaN or infinite knots
+   * and points. Every value is read once to check it. The file is left
+   * closed in that case.
+   */
+  bool open(const char* path);
+
+  /**
+   * close - Unmaps the file. Objects built from it must be destroyed
+   * first, which holding the file in a std::shared_ptr ensures.
+   */
+  void close();
+
+  inline int getCurveCount() const
+  {
+    return (int) m_curves.size();
+  }
+
+  inline const CurveData& getCurve(int i) const
+  {
+    return m_curves[i];
+  }
+
+  inline int getSurfaceCount() const
+  {
+    return (int) m_surfaces.size();
+  }
+
+  inline const SurfaceData& getSurface(int i) const
+  {
+    return m_surfaces[i];
+  }
+};
+
+/**
+ * ControlNetWriter - Writes a ControlNetFile one object at a time. The
+ * control points are converted and written in small blocks, so nets much
+ * larger than the memory can be streamed from their source.
+ */
+class ControlNetWriter {
+private:
+  FILE* m_file;
+  std::string m_path;
+  unsigned long long m_position;
+  unsigned long long m_curveCount, m_surfaceCount;
+  bool m_ok;
+
+  void writeBlock(const void* data, size_t size);
+  void align();
+  void writePoints(int count, const double* x, const double* y, const double* z, const double* w);
+
+  ControlNetWriter(const ControlNetWriter&);
+  ControlNetWriter& operator =(const ControlNetWriter&);
+public:
+  ControlNetWriter() : m_file(NULL), m_position(0), m_curveCount(0), m_surfaceCount(0), m_ok(false) {}
+
+  ~ControlNetWriter()
+  {
+    close();
+  }
+
+  /**
+   * open - Starts a new file, replacing any existing one.
+   * @path: The file.
+   * @returns: false if the file could not be created.
+   */
+  bool open(const char* path);
+
+  /**
+   * addCurve - Appends a curve, with the knot vector and weights
+   * convention of BSplineCurve.
+   * @m: Index of the last control point.
+   * @degree: The degree.
+   * @knots: The m + degree + 1 knots.
+   * @x, @y, @z: The m + 1 coordinates of the control points.
+   * @w: Their weights, or NULL for a non-rational curve.
+   * @returns: false, writing nothing, if the file is not open or the
+   * curve would be rejected by ControlNetFile::open.
+   */
+  bool addCurve(int m, int degree, const double* knots, const double* x, const double* y, const double* z, const double* w);
+
+  /**
+   * addSurface - Appends a surface, with the conventions of
+   * BSplineSurface. The control points are given row after row: point
+   * (i, j) at index i * (n + 1) + j.
+   * @m, @n: Index of the last row and column of the net.
+   * @degreeU, @degreeV: The degrees.
+   * @knotsU, @knotsV: The m + degreeU + 1 and n + degreeV + 1 knots.
+   * @x, @y, @z: The (m + 1) * (n + 1) coordinates of the control points.
+   * @w: Their weights, or NULL for a non-rational surface.
+   * @returns: false, writing nothing, if the file is not open or the
+   * surface would be rejected by ControlNetFile::open.
+   */
+  bool addSurface(int m, int n, int degreeU, int degreeV, const double* knotsU, const double* knotsV,
+                  const double* x, const double* y, const double* z, const double* w);
+
+  /**
+   * close - Finishes the file.
+   * @returns: false if any write failed, in which case the file is
+   * removed.
+   */
+  bool close();
+};
+
+#endif /* __CONTROLNETFILE_H__ */
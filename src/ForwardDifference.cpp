@@ -0,0 +1,152 @@
+/**
+ * File: ForwardDifference.cpp
+ * Author: agent
+ * Implementation of the forward differencing tessellation.
+ * File created on 18 October 2026, 06:36
+ */
+
+#include <vector>
+#include <algorithm>
+#include "ForwardDifference.h"
+
+/**
+ * Number of points generated by additions before the difference table is
+ * computed again from the coefficients.
+ */
+#define FORWARD_DIFFERENCE_RESEED 64
+
+/**
+ * differenceBlock - Writes count points of one coordinate from the
+ * difference table d, advancing it. With the degree known at compile
+ * time the table is held in separate variables, which stay in registers.
+ */
+template<int P>
+static void differenceBlock(double* d, int count, double* out)
+{
+  double r0 = d[0], r1 = d[1];
+  double r2 = (P > 1) ? d[2] : 0.0, r3 = (P > 2) ? d[3] : 0.0;
+  double r4 = (P > 3) ? d[4] : 0.0, r5 = (P > 4) ? d[5] : 0.0;
+  for(int i = 0; i < count; i++) {
+    out[i] = r0;
+    r0 += r1;
+    if(P > 1) r1 += r2;
+    if(P > 2) r2 += r3;
+    if(P > 3) r3 += r4;
+    if(P > 4) r4 += r5;
+  }
+  double r[6] = {r0, r1, r2, r3, r4, r5};
+  for(int j = 0; j <= P; j++)
+    d[j] = r[j];
+}
+
+static void differenceBlock(double* d, int degree, int count, double* out)
+{
+  switch(degree) {
+  case 1: differenceBlock<1>(d, count, out); return;
+  case 2: differenceBlock<2>(d, count, out); return;
+  case 3: differenceBlock<3>(d, count, out); return;
+  case 4: differenceBlock<4>(d, count, out); return;
+  case 5: differenceBlock<5>(d, count, out); return;
+  }
+  for(int i = 0; i < count; i++) {
+    out[i] = d[0];
+    for(int j = 0; j < degree; j++)
+      d[j] += d[j + 1];
+  }
+}
+
+void bezierPowerBasis(const double* points, int degree, double* coefficients)
+{
+  //c_j = C(n, j) * sum_i (-1)^(j - i) * C(j, i) * P_i
+  double binomialN = 1.0;
+  for(int j = 0; j <= degree; j++) {
+    double sum[3] = {0.0, 0.0, 0.0};
+    double binomialJ = 1.0;
+    for(int i = 0; i <= j; i++) {
+      double s = ((j - i) % 2 == 0) ? binomialJ : -binomialJ;
+      for(int c = 0; c < 3; c++)
+        sum[c] += s * points[3 * i + c];
+      binomialJ = binomialJ * (j - i) / (i + 1);
+    }
+    for(int c = 0; c < 3; c++)
+      coefficients[3 * j + c] = binomialN * sum[c];
+    binomialN = binomialN * (degree - j) / (j + 1);
+  }
+}
+
+/**
+ * node - Parameter of the k-th of the degree + 1 equally spaced samples.
+ */
+static inline double node(int k, int degree, double length)
+{
+  return (degree > 0) ? length * k / degree : 0.0;
+}
+
+void interpolatePowerBasis(const double* samples, int degree, double length, double* scratch, double* coefficients)
+{
+  int n = degree + 1;
+  double* a = scratch;
+  double* poly = scratch + n;
+  for(int c = 0; c < 3; c++) {
+    //Diferencas divididas de Newton.
+    for(int k = 0; k < n; k++)
+      a[k] = samples[3 * k + c];
+    for(int j = 1; j < n; j++)
+      for(int k = degree; k >= j; k--)
+        a[k] = (a[k] - a[k - 1]) / (node(k, degree, length) - node(k - j, degree, length));
+    //Forma de Newton expandida de dentro para fora.
+    std::fill(poly, poly + n, 0.0);
+    poly[0] = a[degree];
+    for(int i = degree - 1; i >= 0; i--) {
+      for(int k = degree - i; k > 0; k--)
+        poly[k] = poly[k - 1] - node(i, degree, length) * poly[k];
+      poly[0] = a[i] - node(i, degree, length) * poly[0];
+    }
+    for(int k = 0; k < n; k++)
+      coefficients[3 * k + c] = poly[k];
+  }
+}
+
+void forwardDifferences(const double* coefficients, int degree, double step, int count, double* x, double* y, double* z)
+{
+  int n = degree + 1;
+  //The j-th forward difference of t^k at 0 is step^k * j! * S(k, j),
+  //S being the Stirling numbers of the second kind, so the table is
+  //seeded without subtracting nearby values of the curve.
+  std::vector<double> stirling(n * n, 0.0), seed(n * n, 0.0);
+  stirling[0] = 1.0;
+  for(int k = 1; k < n; k++)
+    for(int j = 1; j <= k; j++)
+      stirling[k * n + j] = j * stirling[(k - 1) * n + j] + stirling[(k - 1) * n + j - 1];
+  double factorial = 1.0;
+  for(int j = 0; j < n; j++) {
+    factorial *= (j > 0) ? j : 1;
+    double power = 1.0;
+    for(int k = 0; k < n; k++) {
+      seed[j * n + k] = power * factorial * stirling[k * n + j];
+      power *= step;
+    }
+  }
+
+  double* out[3] = {x, y, z};
+  std::vector<double> shifted(n), d(n);
+  for(int c = 0; c < 3; c++) {
+    double* o = out[c];
+    for(int first = 0; first < count; first += FORWARD_DIFFERENCE_RESEED) {
+      //Coefficients of the polynomial moved to start at the current point.
+      double t0 = first * step;
+      for(int k = 0; k < n; k++)
+        shifted[k] = coefficients[3 * k + c];
+      for(int i = 0; i < degree; i++)
+        for(int k = degree - 1; k >= i; k--)
+          shifted[k] += t0 * shifted[k + 1];
+      for(int j = 0; j < n; j++) {
+        d[j] = 0.0;
+        for(int k = j; k < n; k++)
+          d[j] += seed[j * n + k] * shifted[k];
+      }
+
+      differenceBlock(&d[0], degree, std::min(count - first, FORWARD_DIFFERENCE_RESEED), o + first);
+    }
+  }
+}
@@ -0,0 +1,47 @@
+/**
+ * File: ForwardDifference.h
+ * Author: agent
+ * Tessellation of polynomial curve pieces by forward differencing, and
+ * conversions of pieces to the power basis it starts from.
+ * File created on 18 October 2026, 06:36
+ */
+
+#ifndef __FORWARDDIFFERENCE_H__
+#define __FORWARDDIFFERENCE_H__
+
+/**
+ * bezierPowerBasis - Converts a Bezier curve to the power basis.
+ * @points: The degree + 1 control points as (x, y, z) triples.
+ * @degree: The degree of the curve.
+ * @coefficients: Receives 3 * (degree + 1) values. The x, y and z
+ * coefficients of u^k are written to coefficients[3 * k].
+ */
+void bezierPowerBasis(const double* points, int degree, double* coefficients);
+
+/**
+ * interpolatePowerBasis - Finds the power basis of the polynomial of a
+ * degree through equally spaced points.
+ * @samples: The degree + 1 points as (x, y, z) triples, the k-th one at
+ * t = length * k / degree.
+ * @degree: The degree of the polynomial.
+ * @length: The parameter interval covered by the samples.
+ * @scratch: Room for 2 * (degree + 1) values.
+ * @coefficients: Receives the coefficients, laid out as in
+ * bezierPowerBasis.
+ */
+void interpolatePowerBasis(const double* samples, int degree, double length, double* scratch, double* coefficients);
+
+/**
+ * forwardDifferences - Evaluates a polynomial at t = 0, step, 2 * step,
+ * ... with degree additions per coordinate and point. The difference
+ * table is computed again from the coefficients every few points, so the
+ * rounding errors the additions accumulate stay bounded.
+ * @coefficients: The power basis, laid out as in bezierPowerBasis.
+ * @degree: The degree of the polynomial.
+ * @step: The parameter step.
+ * @count: Number of points.
+ * @x, @y, @z: Output arrays with count positions each.
+ */
+void forwardDifferences(const double* coefficients, int degree, double step, int count, double* x, double* y, double* z);
+
+#endif /* __FORWARDDIFFERENCE_H__ */
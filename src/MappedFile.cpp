@@ -0,0 +1,42 @@
+/**
+ * File: MappedFile.cpp
+ * Author: agent
+ * Implementation of the MappedFile class.
+ * File created on 18 October 2026, 07:01
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MappedFile.h"
+
+bool MappedFile::open(const char* path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if(fd < 0)
+    return false;
+  struct stat info;
+  if(fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  //O mapeamento continua valido depois de fechar o descritor.
+  void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(data == MAP_FAILED)
+    return false;
+  m_data = (const char*) data;
+  m_size = info.st_size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if(m_data != NULL)
+    munmap((void*) m_data, m_size);
+  m_data = NULL;
+  m_size = 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * File: MappedFile.h
+ * Author: agent
+ * Definition of the MappedFile class, a read only memory mapping of a
+ * whole file.
+ * File created on 18 October 2026, 07:01
+ */
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <cstddef>
+
+/**
+ * MappedFile - Maps a file to memory for reading and unmaps it when
+ * destroyed. Pages are only read from the disk when touched, and the ones
+ * already in the page cache cost no copy at all.
+ */
+class MappedFile {
+private:
+  const char* m_data;
+  size_t m_size;
+
+  MappedFile(const MappedFile&);
+  MappedFile& operator =(const MappedFile&);
+public:
+  MappedFile() : m_data(NULL), m_size(0) {}
+
+  ~MappedFile()
+  {
+    close();
+  }
+
+  /**
+   * open - Maps a file, unmapping the current one first.
+   * @path: The file.
+   * @returns: false if the file could not be opened or mapped, or is
+   * empty.
+   */
+  bool open(const char* path);
+
+  /**
+   * close - Unmaps the file. Pointers into it become invalid.
+   */
+  void close();
+
+  inline bool isOpen() const
+  {
+    return m_data != NULL;
+  }
+
+  inline const char* data() const
+  {
+    return m_data;
+  }
+
+  inline size_t size() const
+  {
+    return m_size;
+  }
+};
+
+#endif /* __MAPPEDFILE_H__ */
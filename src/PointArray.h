@@ -0,0 +1,234 @@
+/**
+ * File: PointArray.h
+ * Author: agent
+ * Definition of the PointArray class, a structure of arrays container for
+ * control and sample points.
+ * File created on 18 October 2026, 06:17
+ */
+
+#ifndef __POINTARRAY_H__
+#define __POINTARRAY_H__
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <CoreMath/Vector4.hpp>
+
+/**
+ * PointArray - Stores n points of D components of type T as D separate
+ * arrays (all x, then all y, ...), each aligned to 32 bytes. The points
+ * carry no per point overhead, the arrays can be copied with memcpy and
+ * loops over a component vectorize.
+ */
+template<typename T, int D>
+class PointArray {
+private:
+  T* m_data;
+  int m_size;
+  int m_capacity;
+  bool m_view;
+
+  static inline int roundCapacity(int n)
+  {
+    return (n + 7) & ~7;
+  }
+public:
+  PointArray() : m_data(NULL), m_size(0), m_capacity(0), m_view(false) {}
+
+  PointArray(const PointArray& rhs) : m_data(NULL), m_size(0), m_capacity(0), m_view(false)
+  {
+    *this = rhs;
+  }
+
+  PointArray(PointArray&& rhs) : m_data(rhs.m_data), m_size(rhs.m_size), m_capacity(rhs.m_capacity), m_view(rhs.m_view)
+  {
+    rhs.m_data = NULL;
+    rhs.m_size = rhs.m_capacity = 0;
+    rhs.m_view = false;
+  }
+
+  ~PointArray()
+  {
+    if(!m_view)
+      free(m_data);
+  }
+
+  PointArray& operator =(const PointArray& rhs)
+  {
+    if(this != &rhs) {
+      resize(rhs.m_size, false);
+      for(int c = 0; c < D && m_size > 0; c++)
+        memcpy(component(c), rhs.component(c), m_size * sizeof(T));
+    }
+    return *this;
+  }
+
+  PointArray& operator =(PointArray&& rhs)
+  {
+    if(this != &rhs) {
+      if(!m_view)
+        free(m_data);
+      m_data = rhs.m_data;
+      m_size = rhs.m_size;
+      m_capacity = rhs.m_capacity;
+      m_view = rhs.m_view;
+      rhs.m_data = NULL;
+      rhs.m_size = rhs.m_capacity = 0;
+      rhs.m_view = false;
+    }
+    return *this;
+  }
+
+  inline int size() const
+  {
+    return m_size;
+  }
+
+  inline bool empty() const
+  {
+    return m_size == 0;
+  }
+
+  inline void clear()
+  {
+    if(m_view) {
+      m_data = NULL;
+      m_capacity = 0;
+      m_view = false;
+    }
+    m_size = 0;
+  }
+
+  /**
+   * setView - Makes the array refer to points stored elsewhere, such as a
+   * memory mapped file, without copying them. The storage must hold the
+   * D components one after the other, stride elements apart, and outlive
+   * the view. Views are read only: the non const accessors must not be
+   * used to write through them, and resize first copies the points to
+   * storage of the array itself.
+   * @data: The first component of the first point.
+   * @size: Number of points.
+   * @stride: Distance between the components, at least size.
+   */
+  inline void setView(const T* data, int size, int stride)
+  {
+    if(!m_view)
+      free(m_data);
+    m_data = const_cast<T*>(data);
+    m_size = size;
+    m_capacity = stride;
+    m_view = true;
+  }
+
+  /**
+   * isView - Returns whether the points are stored elsewhere. See
+   * setView.
+   */
+  inline bool isView() const
+  {
+    return m_view;
+  }
+
+  /**
+   * resize - Changes the number of points.
+   * @n: The new number of points.
+   * @keep: Whether the first min(n, size()) points must be preserved.
+   * New points are left uninitialized. A view always gets storage of
+   * its own. Throws std::bad_alloc, leaving the array unchanged, when the
+   * storage cannot be allocated.
+   */
+  void resize(int n, bool keep = true)
+  {
+    if(n > m_capacity || m_view) {
+      int capacity = roundCapacity(m_view || n > 2 * m_capacity ? n : 2 * m_capacity);
+      void* data = NULL;
+      if(posix_memalign(&data, 32, (size_t) D * capacity * sizeof(T)) != 0)
+        throw std::bad_alloc();
+      T* newData = (T*) data;
+      if(keep && m_size > 0)
+        for(int c = 0; c < D; c++)
+          memcpy(newData + (size_t) c * capacity, component(c), std::min(n, m_size) * sizeof(T));
+      if(!m_view)
+        free(m_data);
+      m_data = newData;
+      m_view = false;
+      m_capacity = capacity;
+    }
+    m_size = n;
+  }
+
+  /**
+   * component - Returns the array holding one component of every point.
+   * @c: The component (0 for x, 1 for y, ...).
+   */
+  inline T* component(int c)
+  {
+    return m_data + (size_t) c * m_capacity;
+  }
+
+  inline const T* component(int c) const
+  {
+    return m_data + (size_t) c * m_capacity;
+  }
+
+  inline T* x() { return component(0); }
+  inline T* y() { return component(1); }
+  inline T* z() { return component(2); }
+  inline T* w() { return component(3); }
+  inline const T* x() const { return component(0); }
+  inline const T* y() const { return component(1); }
+  inline const T* z() const { return component(2); }
+  inline const T* w() const { return component(3); }
+
+  /**
+   * set - Assigns the components of a point. Components beyond D are
+   * ignored.
+   */
+  inline void set(int i, T x, T y, T z, T w = 1)
+  {
+    T v[4] = {x, y, z, w};
+    for(int c = 0; c < D; c++)
+      component(c)[i] = v[c];
+  }
+
+  /**
+   * operator[]: Compatibility view of a point as a CoreMath::Vector4. The
+   * w component is 1 when D < 4.
+   * @returns: A copy of the i-th point.
+   */
+  inline CoreMath::Vector4 operator [](int i) const
+  {
+    CoreMath::Scalar v[4] = {0, 0, 0, 1};
+    for(int c = 0; c < D && c < 4; c++)
+      v[c] = (CoreMath::Scalar) component(c)[i];
+    return CoreMath::Vector4(v[0], v[1], v[2], v[3]);
+  }
+
+  /**
+   * toVectors - Copies the points to an array of CoreMath::Vector4, for
+   * code written against the old representation.
+   */
+  std::vector<CoreMath::Vector4> toVectors() const
+  {
+    std::vector<CoreMath::Vector4> v;
+    v.reserve(m_size);
+    for(int i = 0; i < m_size; i++)
+      v.push_back((*this)[i]);
+    return v;
+  }
+};
+
+/**
+ * RenderPoints - Tessellated points, in the precision of CoreMath.
+ */
+typedef PointArray<CoreMath::Scalar, 3> RenderPoints;
+
+/**
+ * HomogeneousPoints - Control points premultiplied by their weights,
+ * (x * w, y * w, z * w, w), in double precision.
+ */
+typedef PointArray<double, 4> HomogeneousPoints;
+
+#endif /* __POINTARRAY_H__ */
@@ -0,0 +1,72 @@
+/**
+ * File: PointTransform.cpp
+ * Author: agent
+ * Implementation of the render point transforms.
+ * File created on 18 October 2026, 06:24
+ */
+
+#include <algorithm>
+#include "PointTransform.h"
+#include "ThreadPool.h"
+
+/**
+ * Number of points transformed by each parallel task.
+ */
+#define TRANSFORM_CHUNK 16384
+
+typedef void (CoreMath::Matrix4::*ArrayTransform)(const CoreMath::Scalar*, const CoreMath::Scalar*, const CoreMath::Scalar*, CoreMath::Scalar*, CoreMath::Scalar*, CoreMath::Scalar*, int) const;
+
+static void applyTransform(const CoreMath::Matrix4& matrix, ArrayTransform transform, const RenderPoints& in, RenderPoints& out, bool parallel)
+{
+  int count = in.size();
+  if(&out != &in)
+    out.resize(count, false);
+  const CoreMath::Scalar* x = in.x();
+  const CoreMath::Scalar* y = in.y();
+  const CoreMath::Scalar* z = in.z();
+  CoreMath::Scalar* ox = out.x();
+  CoreMath::Scalar* oy = out.y();
+  CoreMath::Scalar* oz = out.z();
+
+  int chunks = (count + TRANSFORM_CHUNK - 1) / TRANSFORM_CHUNK;
+  if(!parallel || chunks < 2) {
+    (matrix.*transform)(x, y, z, ox, oy, oz, count);
+    return;
+  }
+  ThreadPool::shared().parallelFor(chunks, [&](int c) {
+    int first = c * TRANSFORM_CHUNK;
+    int n = std::min(TRANSFORM_CHUNK, count - first);
+    (matrix.*transform)(x + first, y + first, z + first, ox + first, oy + first, oz + first, n);
+  });
+}
+
+void transformPoints(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel)
+{
+  applyTransform(matrix, &CoreMath::Matrix4::transformPoints, in, out, parallel);
+}
+
+void projectPoints(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel)
+{
+  applyTransform(matrix, &CoreMath::Matrix4::projectPoints, in, out, parallel);
+}
+
+void transformDirections(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel)
+{
+  applyTransform(matrix, &CoreMath::Matrix4::transformDirections, in, out, parallel);
+}
+
+CoreMath::Matrix4 affinePart(const CoreMath::Matrix4& matrix)
+{
+  CoreMath::Matrix4 affine(matrix);
+  affine.setLine(3, CoreMath::Vector4(0, 0, 0, 1));
+  return affine;
+}
+
+void transformControlPoints(const CoreMath::Matrix4& matrix, std::vector<CoreMath::Vector4>& points)
+{
+  CoreMath::Matrix4 affine = affinePart(matrix);
+  for(unsigned int i = 0; i < points.size(); i++) {
+    CoreMath::Vector4 p = affine * CoreMath::Vector4(points[i][0], points[i][1], points[i][2]);
+    points[i] = CoreMath::Vector4(p[0], p[1], p[2], points[i][3]);
+  }
+}
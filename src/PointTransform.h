@@ -0,0 +1,104 @@
+/**
+ * File: PointTransform.h
+ * Author: agent
+ * Functions that apply a CoreMath::Matrix4 to whole arrays of render
+ * points, optionally splitting the work over the shared ThreadPool.
+ * File created on 18 October 2026, 06:24
+ */
+
+#ifndef __POINTTRANSFORM_H__
+#define __POINTTRANSFORM_H__
+
+#include <vector>
+#include <CoreMath/Matrix4.hpp>
+#include "PointArray.h"
+
+/**
+ * transformPoints - Transforms every point of an array, as
+ * Matrix4::transformPoints.
+ * @matrix: The transform.
+ * @in: The points to be transformed.
+ * @out: Receives the transformed points. It is resized to the size of in
+ * and may be the same array.
+ * @parallel: Whether large arrays are split over the shared ThreadPool.
+ */
+void transformPoints(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel = false);
+
+/**
+ * projectPoints - Same as transformPoints, but the results are divided by
+ * their w, as Matrix4::projectPoints.
+ */
+void projectPoints(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel = false);
+
+/**
+ * transformDirections - Same as transformPoints for direction vectors,
+ * which are not translated, as Matrix4::transformDirections.
+ */
+void transformDirections(const CoreMath::Matrix4& matrix, const RenderPoints& in, RenderPoints& out, bool parallel = false);
+
+/**
+ * affinePart - Returns a copy of a matrix with its last line replaced by
+ * (0, 0, 0, 1), which is the transform transformPoints applies.
+ */
+CoreMath::Matrix4 affinePart(const CoreMath::Matrix4& matrix);
+
+/**
+ * transformControlPoints - Applies an affine transform to the x, y and z
+ * of control points. Their w is kept.
+ * @matrix: The transform. Its last line is ignored.
+ * @points: The points to be transformed.
+ */
+void transformControlPoints(const CoreMath::Matrix4& matrix, std::vector<CoreMath::Vector4>& points);
+
+/**
+ * PendingTransform - An affine transform waiting to be applied to a
+ * tessellation. Transforms given in sequence are composed, so the points
+ * are transformed once, when they are next used, however many transforms
+ * were given in between.
+ */
+class PendingTransform {
+private:
+  CoreMath::Matrix4 m_matrix;
+  bool m_pending;
+public:
+  PendingTransform() : m_pending(false) {}
+
+  inline bool isPending() const
+  {
+    return m_pending;
+  }
+
+  /**
+   * append - Composes a transform after the pending one.
+   * @matrix: The transform. Its last line is ignored.
+   */
+  inline void append(const CoreMath::Matrix4& matrix)
+  {
+    m_matrix = m_pending ? affinePart(matrix) * m_matrix : affinePart(matrix);
+    m_pending = true;
+  }
+
+  /**
+   * cancel - Drops the pending transform, for when the tessellation is
+   * generated again.
+   */
+  inline void cancel()
+  {
+    m_pending = false;
+  }
+
+  /**
+   * apply - Transforms the points in place if a transform is pending.
+   * @points: The tessellation.
+   * @parallel: Whether large arrays are split over the shared ThreadPool.
+   */
+  inline void apply(RenderPoints& points, bool parallel)
+  {
+    if(m_pending) {
+      transformPoints(m_matrix, points, points, parallel);
+      m_pending = false;
+    }
+  }
+};
+
+#endif /* __POINTTRANSFORM_H__ */
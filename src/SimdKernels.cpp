@@ -0,0 +1,313 @@
+/**
+ * File: SimdKernels.cpp
+ * Author: agent
+ * Implementation of the vectorized evaluation kernels. The SSE2 and AVX2
+ * versions perform exactly the same operations as the scalar one, lane
+ * by lane, so all of them give the same results.
+ * File created on 18 October 2026, 06:08
+ */
+
+#include "SimdKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMDKERNELS_X86
+#include <immintrin.h>
+#endif
+
+static SimdMode bestSimdMode()
+{
+#ifdef SIMDKERNELS_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if(__builtin_cpu_supports("sse2"))
+    return SIMD_SSE2;
+#endif
+  return SIMD_NONE;
+}
+
+static SimdMode g_bestSimdMode = bestSimdMode();
+static SimdMode g_simdMode = g_bestSimdMode;
+
+void setSimdMode(SimdMode mode)
+{
+  if(mode == SIMD_AUTO || mode > g_bestSimdMode)
+    g_simdMode = g_bestSimdMode;
+  else
+    g_simdMode = mode;
+}
+
+SimdMode getSimdMode()
+{
+  return g_simdMode;
+}
+
+/*
+ * Scalar kernels.
+ */
+
+static void cubicBSplineScalar(const CubicSpan& s, const double* u, int count, double* x, double* y, double* z)
+{
+  const double* U = s.knots;
+  const double* P = s.points;
+  for(int k = 0; k < count; k++) {
+    double t = u[k];
+    double left1 = t - U[2];
+    double left2 = t - U[1];
+    double left3 = t - U[0];
+    double right1 = U[3] - t;
+    double right2 = U[4] - t;
+    double right3 = U[5] - t;
+
+    double N0 = right1 * s.inv[0];
+    double N1 = left1 * s.inv[0];
+    double temp = N0 * s.inv[1];
+    N0 = right1 * temp;
+    double saved = left2 * temp;
+    temp = N1 * s.inv[2];
+    N1 = saved + right2 * temp;
+    double N2 = left1 * temp;
+    temp = N0 * s.inv[3];
+    N0 = right1 * temp;
+    saved = left3 * temp;
+    temp = N1 * s.inv[4];
+    N1 = saved + right2 * temp;
+    saved = left2 * temp;
+    temp = N2 * s.inv[5];
+    N2 = saved + right3 * temp;
+    double N3 = left1 * temp;
+
+    double hx = N0 * P[0] + N1 * P[4] + N2 * P[8] + N3 * P[12];
+    double hy = N0 * P[1] + N1 * P[5] + N2 * P[9] + N3 * P[13];
+    double hz = N0 * P[2] + N1 * P[6] + N2 * P[10] + N3 * P[14];
+    double hw = N0 * P[3] + N1 * P[7] + N2 * P[11] + N3 * P[15];
+    double iw = 1.0 / hw;
+    x[k] = hx * iw;
+    y[k] = hy * iw;
+    z[k] = hz * iw;
+  }
+}
+
+static void cubicBezierScalar(const double* P, const double* u, int count, double* x, double* y, double* z)
+{
+  for(int k = 0; k < count; k++) {
+    double t = u[k];
+    double s = 1.0 - t;
+    double ss = s * s;
+    double tt = t * t;
+    double b0 = ss * s;
+    double b1 = 3.0 * t * ss;
+    double b2 = 3.0 * tt * s;
+    double b3 = tt * t;
+    x[k] = b0 * P[0] + b1 * P[3] + b2 * P[6] + b3 * P[9];
+    y[k] = b0 * P[1] + b1 * P[4] + b2 * P[7] + b3 * P[10];
+    z[k] = b0 * P[2] + b1 * P[5] + b2 * P[8] + b3 * P[11];
+  }
+}
+
+#ifdef SIMDKERNELS_X86
+
+/*
+ * SSE2 kernels, two parameters at a time.
+ */
+
+__attribute__((target("sse2")))
+static int cubicBSplineSSE2(const CubicSpan& s, const double* u, int count, double* x, double* y, double* z)
+{
+  __m128d U0 = _mm_set1_pd(s.knots[0]), U1 = _mm_set1_pd(s.knots[1]), U2 = _mm_set1_pd(s.knots[2]);
+  __m128d U3 = _mm_set1_pd(s.knots[3]), U4 = _mm_set1_pd(s.knots[4]), U5 = _mm_set1_pd(s.knots[5]);
+  __m128d I[6];
+  __m128d P[16];
+  for(int i = 0; i < 6; i++)
+    I[i] = _mm_set1_pd(s.inv[i]);
+  for(int i = 0; i < 16; i++)
+    P[i] = _mm_set1_pd(s.points[i]);
+  __m128d one = _mm_set1_pd(1.0);
+
+  int k = 0;
+  for(; k + 2 <= count; k += 2) {
+    __m128d t = _mm_loadu_pd(u + k);
+    __m128d left1 = _mm_sub_pd(t, U2);
+    __m128d left2 = _mm_sub_pd(t, U1);
+    __m128d left3 = _mm_sub_pd(t, U0);
+    __m128d right1 = _mm_sub_pd(U3, t);
+    __m128d right2 = _mm_sub_pd(U4, t);
+    __m128d right3 = _mm_sub_pd(U5, t);
+
+    __m128d N0 = _mm_mul_pd(right1, I[0]);
+    __m128d N1 = _mm_mul_pd(left1, I[0]);
+    __m128d temp = _mm_mul_pd(N0, I[1]);
+    N0 = _mm_mul_pd(right1, temp);
+    __m128d saved = _mm_mul_pd(left2, temp);
+    temp = _mm_mul_pd(N1, I[2]);
+    N1 = _mm_add_pd(saved, _mm_mul_pd(right2, temp));
+    __m128d N2 = _mm_mul_pd(left1, temp);
+    temp = _mm_mul_pd(N0, I[3]);
+    N0 = _mm_mul_pd(right1, temp);
+    saved = _mm_mul_pd(left3, temp);
+    temp = _mm_mul_pd(N1, I[4]);
+    N1 = _mm_add_pd(saved, _mm_mul_pd(right2, temp));
+    saved = _mm_mul_pd(left2, temp);
+    temp = _mm_mul_pd(N2, I[5]);
+    N2 = _mm_add_pd(saved, _mm_mul_pd(right3, temp));
+    __m128d N3 = _mm_mul_pd(left1, temp);
+
+    __m128d h[4];
+    for(int c = 0; c < 4; c++) {
+      h[c] = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(N0, P[c]), _mm_mul_pd(N1, P[4 + c])),
+                                   _mm_mul_pd(N2, P[8 + c])), _mm_mul_pd(N3, P[12 + c]));
+    }
+    __m128d iw = _mm_div_pd(one, h[3]);
+    _mm_storeu_pd(x + k, _mm_mul_pd(h[0], iw));
+    _mm_storeu_pd(y + k, _mm_mul_pd(h[1], iw));
+    _mm_storeu_pd(z + k, _mm_mul_pd(h[2], iw));
+  }
+  return k;
+}
+
+__attribute__((target("sse2")))
+static int cubicBezierSSE2(const double* points, const double* u, int count, double* x, double* y, double* z)
+{
+  __m128d P[12];
+  for(int i = 0; i < 12; i++)
+    P[i] = _mm_set1_pd(points[i]);
+  __m128d one = _mm_set1_pd(1.0);
+  __m128d three = _mm_set1_pd(3.0);
+
+  int k = 0;
+  for(; k + 2 <= count; k += 2) {
+    __m128d t = _mm_loadu_pd(u + k);
+    __m128d s = _mm_sub_pd(one, t);
+    __m128d ss = _mm_mul_pd(s, s);
+    __m128d tt = _mm_mul_pd(t, t);
+    __m128d b0 = _mm_mul_pd(ss, s);
+    __m128d b1 = _mm_mul_pd(_mm_mul_pd(three, t), ss);
+    __m128d b2 = _mm_mul_pd(_mm_mul_pd(three, tt), s);
+    __m128d b3 = _mm_mul_pd(tt, t);
+    double* out[3] = {x, y, z};
+    for(int c = 0; c < 3; c++) {
+      __m128d r = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(b0, P[c]), _mm_mul_pd(b1, P[3 + c])),
+                                        _mm_mul_pd(b2, P[6 + c])), _mm_mul_pd(b3, P[9 + c]));
+      _mm_storeu_pd(out[c] + k, r);
+    }
+  }
+  return k;
+}
+
+/*
+ * AVX2 kernels, four parameters at a time.
+ */
+
+__attribute__((target("avx2")))
+static int cubicBSplineAVX2(const CubicSpan& s, const double* u, int count, double* x, double* y, double* z)
+{
+  __m256d U0 = _mm256_set1_pd(s.knots[0]), U1 = _mm256_set1_pd(s.knots[1]), U2 = _mm256_set1_pd(s.knots[2]);
+  __m256d U3 = _mm256_set1_pd(s.knots[3]), U4 = _mm256_set1_pd(s.knots[4]), U5 = _mm256_set1_pd(s.knots[5]);
+  __m256d I[6];
+  __m256d P[16];
+  for(int i = 0; i < 6; i++)
+    I[i] = _mm256_set1_pd(s.inv[i]);
+  for(int i = 0; i < 16; i++)
+    P[i] = _mm256_set1_pd(s.points[i]);
+  __m256d one = _mm256_set1_pd(1.0);
+
+  int k = 0;
+  for(; k + 4 <= count; k += 4) {
+    __m256d t = _mm256_loadu_pd(u + k);
+    __m256d left1 = _mm256_sub_pd(t, U2);
+    __m256d left2 = _mm256_sub_pd(t, U1);
+    __m256d left3 = _mm256_sub_pd(t, U0);
+    __m256d right1 = _mm256_sub_pd(U3, t);
+    __m256d right2 = _mm256_sub_pd(U4, t);
+    __m256d right3 = _mm256_sub_pd(U5, t);
+
+    __m256d N0 = _mm256_mul_pd(right1, I[0]);
+    __m256d N1 = _mm256_mul_pd(left1, I[0]);
+    __m256d temp = _mm256_mul_pd(N0, I[1]);
+    N0 = _mm256_mul_pd(right1, temp);
+    __m256d saved = _mm256_mul_pd(left2, temp);
+    temp = _mm256_mul_pd(N1, I[2]);
+    N1 = _mm256_add_pd(saved, _mm256_mul_pd(right2, temp));
+    __m256d N2 = _mm256_mul_pd(left1, temp);
+    temp = _mm256_mul_pd(N0, I[3]);
+    N0 = _mm256_mul_pd(right1, temp);
+    saved = _mm256_mul_pd(left3, temp);
+    temp = _mm256_mul_pd(N1, I[4]);
+    N1 = _mm256_add_pd(saved, _mm256_mul_pd(right2, temp));
+    saved = _mm256_mul_pd(left2, temp);
+    temp = _mm256_mul_pd(N2, I[5]);
+    N2 = _mm256_add_pd(saved, _mm256_mul_pd(right3, temp));
+    __m256d N3 = _mm256_mul_pd(left1, temp);
+
+    __m256d h[4];
+    for(int c = 0; c < 4; c++) {
+      h[c] = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(N0, P[c]), _mm256_mul_pd(N1, P[4 + c])),
+                                         _mm256_mul_pd(N2, P[8 + c])), _mm256_mul_pd(N3, P[12 + c]));
+    }
+    __m256d iw = _mm256_div_pd(one, h[3]);
+    _mm256_storeu_pd(x + k, _mm256_mul_pd(h[0], iw));
+    _mm256_storeu_pd(y + k, _mm256_mul_pd(h[1], iw));
+    _mm256_storeu_pd(z + k, _mm256_mul_pd(h[2], iw));
+  }
+  return k;
+}
+
+__attribute__((target("avx2")))
+static int cubicBezierAVX2(const double* points, const double* u, int count, double* x, double* y, double* z)
+{
+  __m256d P[12];
+  for(int i = 0; i < 12; i++)
+    P[i] = _mm256_set1_pd(points[i]);
+  __m256d one = _mm256_set1_pd(1.0);
+  __m256d three = _mm256_set1_pd(3.0);
+
+  int k = 0;
+  for(; k + 4 <= count; k += 4) {
+    __m256d t = _mm256_loadu_pd(u + k);
+    __m256d s = _mm256_sub_pd(one, t);
+    __m256d ss = _mm256_mul_pd(s, s);
+    __m256d tt = _mm256_mul_pd(t, t);
+    __m256d b0 = _mm256_mul_pd(ss, s);
+    __m256d b1 = _mm256_mul_pd(_mm256_mul_pd(three, t), ss);
+    __m256d b2 = _mm256_mul_pd(_mm256_mul_pd(three, tt), s);
+    __m256d b3 = _mm256_mul_pd(tt, t);
+    double* out[3] = {x, y, z};
+    for(int c = 0; c < 3; c++) {
+      __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(b0, P[c]), _mm256_mul_pd(b1, P[3 + c])),
+                                              _mm256_mul_pd(b2, P[6 + c])), _mm256_mul_pd(b3, P[9 + c]));
+      _mm256_storeu_pd(out[c] + k, r);
+    }
+  }
+  return k;
+}
+
+#endif /* SIMDKERNELS_X86 */
+
+/*
+ * Dispatchers. The vector kernels return how many parameters they
+ * handled and the scalar kernel finishes the remainder.
+ */
+
+void evaluateCubicBSpline(const CubicSpan& span, const double* u, int count, double* x, double* y, double* z)
+{
+  int done = 0;
+#ifdef SIMDKERNELS_X86
+  if(g_simdMode == SIMD_AVX2)
+    done = cubicBSplineAVX2(span, u, count, x, y, z);
+  else if(g_simdMode == SIMD_SSE2)
+    done = cubicBSplineSSE2(span, u, count, x, y, z);
+#endif
+  cubicBSplineScalar(span, u + done, count - done, x + done, y + done, z + done);
+}
+
+void evaluateCubicBezier(const double* points, const double* u, int count, double* x, double* y, double* z)
+{
+  int done = 0;
+#ifdef SIMDKERNELS_X86
+  if(g_simdMode == SIMD_AVX2)
+    done = cubicBezierAVX2(points, u, count, x, y, z);
+  else if(g_simdMode == SIMD_SSE2)
+    done = cubicBezierSSE2(points, u, count, x, y, z);
+#endif
+  cubicBezierScalar(points, u + done, count - done, x + done, y + done, z + done);
+}
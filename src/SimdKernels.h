@@ -0,0 +1,72 @@
+/**
+ * File: SimdKernels.h
+ * Author: agent
+ * Vectorized evaluation kernels for cubic B-Spline and Bezier curves.
+ * File created on 18 October 2026, 06:08
+ */
+
+#ifndef __SIMDKERNELS_H__
+#define __SIMDKERNELS_H__
+
+/**
+ * SimdMode - Instruction sets the kernels can run with. SIMD_AUTO picks
+ * the widest one supported by the CPU.
+ */
+enum SimdMode {
+  SIMD_AUTO,
+  SIMD_NONE,
+  SIMD_SSE2,
+  SIMD_AVX2
+};
+
+/**
+ * CubicSpan - Everything a cubic kernel needs to evaluate one knot span.
+ * @knots: The knots U[span - 2] to U[span + 3].
+ * @inv: The reciprocals of the span, in the layout of
+ * BSplineCurve::spanReciprocals.
+ * @points: The four affected control points in homogeneous coordinates
+ * (x * w, y * w, z * w, w).
+ */
+struct CubicSpan {
+  double knots[6];
+  double inv[6];
+  double points[16];
+};
+
+/**
+ * setSimdMode - Selects the kernels used by the curves. Requesting an
+ * instruction set the CPU lacks falls back to the best supported one, so
+ * SIMD_NONE can always be used to check the vectorized results against
+ * the scalar ones. Cubic spans a curve forward differences (see
+ * BSplineCurve::setForwardDifferencing) do not use the kernels.
+ * @mode: The desired mode.
+ */
+void setSimdMode(SimdMode mode);
+
+/**
+ * getSimdMode - Returns the instruction set actually in use. It is never
+ * SIMD_AUTO.
+ */
+SimdMode getSimdMode();
+
+/**
+ * evaluateCubicBSpline - Evaluates a rational cubic B-Spline span at
+ * many parameters.
+ * @span: The span description.
+ * @u: Parameters, which should lie in the span.
+ * @count: Number of parameters.
+ * @x, @y, @z: Output arrays with count positions each.
+ */
+void evaluateCubicBSpline(const CubicSpan& span, const double* u, int count, double* x, double* y, double* z);
+
+/**
+ * evaluateCubicBezier - Evaluates a cubic Bezier curve at many
+ * parameters.
+ * @points: The four control points as (x, y, z) triples.
+ * @u: Parameters in [0, 1].
+ * @count: Number of parameters.
+ * @x, @y, @z: Output arrays with count positions each.
+ */
+void evaluateCubicBezier(const double* points, const double* u, int count, double* x, double* y, double* z);
+
+#endif /* __SIMDKERNELS_H__ */
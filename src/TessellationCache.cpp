@@ -0,0 +1,157 @@
+/**
+ * File: TessellationCache.cpp
+ * Author: agent
+ * Implementation of the TessellationCache class.
+ * File created on 18 October 2026, 06:56
+ */
+
+#include "TessellationCache.h"
+#include "TessellationSnapshot.h"
+
+TessellationCache::TessellationCache(size_t budget) : m_budget(budget), m_usage(0), m_hits(0), m_misses(0), m_evictions(0), m_snapshotHits(0), m_snapshot(NULL)
+{
+}
+
+TessellationCache& TessellationCache::shared()
+{
+  static TessellationCache cache;
+  return cache;
+}
+
+std::shared_ptr<const Tessellation> TessellationCache::find(const TessellationKey& key)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(key);
+    if(found != m_index.end()) {
+      m_hits++;
+      m_entries.splice(m_entries.begin(), m_entries, found->second);
+      return found->second->tessellation;
+    }
+  }
+  //A copia do snapshot e feita sem travar o cache.
+  Tessellation loaded;
+  if(m_snapshot != NULL && m_snapshot->find(key, loaded)) {
+    std::shared_ptr<const Tessellation> shared = insert(key, std::move(loaded));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hits++;
+    m_snapshotHits++;
+    return shared;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_misses++;
+  return std::shared_ptr<const Tessellation>();
+}
+
+std::shared_ptr<const Tessellation> TessellationCache::insert(const TessellationKey& key, Tessellation&& tessellation)
+{
+  std::shared_ptr<const Tessellation> shared(new Tessellation(std::move(tessellation)));
+  //The key is stored twice, in the entry and in the index.
+  size_t bytes = shared->memoryUsage() + 2 * key.size();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto found = m_index.find(key);
+  if(found != m_index.end()) {
+    m_entries.splice(m_entries.begin(), m_entries, found->second);
+    return found->second->tessellation;
+  }
+  if(bytes > m_budget)
+    return shared;
+  evict(m_budget - bytes);
+  Entry entry;
+  entry.key = key;
+  entry.tessellation = shared;
+  entry.bytes = bytes;
+  m_entries.push_front(entry);
+  m_index[key] = m_entries.begin();
+  m_usage += bytes;
+  return shared;
+}
+
+void TessellationCache::evict(size_t budget)
+{
+  while(m_usage > budget && !m_entries.empty()) {
+    Entry& last = m_entries.back();
+    m_usage -= last.bytes;
+    m_index.erase(last.key);
+    m_entries.pop_back();
+    m_evictions++;
+  }
+}
+
+void TessellationCache::setBudget(size_t budget)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_budget = budget;
+  evict(m_budget);
+}
+
+void TessellationCache::setSnapshot(const TessellationSnapshot* snapshot)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_snapshot = snapshot;
+}
+
+void TessellationCache::getEntries(std::vector<std::pair<TessellationKey, std::shared_ptr<const Tessellation> > >& entries) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  entries.clear();
+  entries.reserve(m_entries.size());
+  for(auto e = m_entries.begin(); e != m_entries.end(); ++e)
+    entries.push_back(std::make_pair(e->key, e->tessellation));
+}
+
+void TessellationCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_index.clear();
+  m_entries.clear();
+  m_usage = 0;
+}
+
+void TessellationCache::resetCounters()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_hits = m_misses = m_evictions = m_snapshotHits = 0;
+}
+
+size_t TessellationCache::getBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_budget;
+}
+
+size_t TessellationCache::getMemoryUsage() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_usage;
+}
+
+size_t TessellationCache::getEntryCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+unsigned long TessellationCache::getHits() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hits;
+}
+
+unsigned long TessellationCache::getMisses() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_misses;
+}
+
+unsigned long TessellationCache::getEvictions() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_evictions;
+}
+
+unsigned long TessellationCache::getSnapshotHits() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_snapshotHits;
+}
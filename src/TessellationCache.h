@@ -0,0 +1,219 @@
+/**
+ * File: TessellationCache.h
+ * Author: agent
+ * Definition of the TessellationCache class, which shares the
+ * tessellations of identical curves and surfaces.
+ * File created on 18 October 2026, 06:56
+ */
+
+#ifndef __TESSELLATIONCACHE_H__
+#define __TESSELLATIONCACHE_H__
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "PointArray.h"
+
+/**
+ * Tessellation - The output of generateCurve or generateSurface, as kept
+ * by the cache. Once cached it is never modified: objects using it copy
+ * it before changing it.
+ */
+struct Tessellation {
+  RenderPoints points;
+
+  /**
+   * Offsets of the knot spans of a curve in points. Empty for surfaces.
+   */
+  std::vector<int> spanOffsets;
+
+  /**
+   * Size of the grid of a surface. Zero for curves.
+   */
+  int rows, columns;
+
+  Tessellation() : rows(0), columns(0) {}
+
+  /**
+   * memoryUsage - Returns the number of bytes held by the tessellation.
+   */
+  inline size_t memoryUsage() const
+  {
+    return sizeof(Tessellation) + 3 * points.size() * sizeof(CoreMath::Scalar) + spanOffsets.size() * sizeof(int);
+  }
+};
+
+/**
+ * TessellationKey - Everything a tessellation depends on, as raw bytes,
+ * and their 64 bit FNV-1a hash. Two keys are only equal when all their
+ * bytes are, so a hash collision never returns a wrong tessellation.
+ */
+class TessellationKey {
+private:
+  std::string m_bytes;
+  unsigned long long m_hash;
+public:
+  TessellationKey() : m_hash(14695981039346656037ULL) {}
+
+  /**
+   * add - Appends raw data to the key.
+   * @data: The data.
+   * @size: Its size in bytes.
+   */
+  inline void add(const void* data, size_t size)
+  {
+    const unsigned char* bytes = (const unsigned char*) data;
+    for(size_t i = 0; i < size; i++)
+      m_hash = (m_hash ^ bytes[i]) * 1099511628211ULL;
+    m_bytes.append((const char*) data, size);
+  }
+
+  /**
+   * add - Appends a value of a plain type to the key.
+   */
+  template<typename T>
+  inline void add(const T& value)
+  {
+    add(&value, sizeof(T));
+  }
+
+  inline unsigned long long hash() const
+  {
+    return m_hash;
+  }
+
+  inline size_t size() const
+  {
+    return m_bytes.size();
+  }
+
+  inline const char* data() const
+  {
+    return m_bytes.data();
+  }
+
+  inline bool operator ==(const TessellationKey& rhs) const
+  {
+    return m_hash == rhs.m_hash && m_bytes == rhs.m_bytes;
+  }
+};
+
+class TessellationSnapshot;
+
+class TessellationCache {
+private:
+  struct Entry {
+    TessellationKey key;
+    std::shared_ptr<const Tessellation> tessellation;
+    size_t bytes;
+  };
+
+  struct KeyHash {
+    inline size_t operator ()(const TessellationKey& key) const
+    {
+      return (size_t) key.hash();
+    }
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  //Most recently used first.
+  EntryList m_entries;
+  std::unordered_map<TessellationKey, EntryList::iterator, KeyHash> m_index;
+  size_t m_budget;
+  size_t m_usage;
+  unsigned long m_hits, m_misses, m_evictions, m_snapshotHits;
+  const TessellationSnapshot* m_snapshot;
+  mutable std::mutex m_mutex;
+
+  void evict(size_t budget);
+public:
+  /**
+   * TessellationCache - Creates an empty cache.
+   * @budget: Largest number of bytes held by the cached tessellations.
+   */
+  TessellationCache(size_t budget = 64 << 20);
+
+  /**
+   * shared - Returns a cache shared by the whole program.
+   */
+  static TessellationCache& shared();
+
+  /**
+   * find - Looks a tessellation up, marking it as the most recently used
+   * one and counting a hit or a miss. Entries missing from the cache are
+   * then looked up in the snapshot, if any, and added to the cache.
+   * @key: The definition of the tessellation.
+   * @returns: The tessellation, or an empty pointer.
+   */
+  std::shared_ptr<const Tessellation> find(const TessellationKey& key);
+
+  /**
+   * insert - Adds a tessellation, evicting the least recently used ones
+   * beyond the budget. A tessellation larger than the whole budget is not
+   * kept, but is still returned.
+   * @key: The definition of the tessellation.
+   * @tessellation: The tessellation, which is moved into the cache.
+   * @returns: The shared tessellation. When the key was already present,
+   * the one cached before.
+   */
+  std::shared_ptr<const Tessellation> insert(const TessellationKey& key, Tessellation&& tessellation);
+
+  /**
+   * setBudget - Changes the memory budget, evicting entries if needed.
+   * @budget: Largest number of bytes held by the cached tessellations.
+   */
+  void setBudget(size_t budget);
+
+  /**
+   * setSnapshot - Attaches a snapshot saved by a previous run, which find
+   * consults before reporting a miss. Must be called before the cache is
+   * used by other threads.
+   * @snapshot: The snapshot, which must stay open while attached, or NULL
+   * to detach it.
+   */
+  void setSnapshot(const TessellationSnapshot* snapshot);
+
+  /**
+   * getEntries - Copies the list of entries, most recently used first.
+   * The tessellations are shared, not copied.
+   * @entries: Receives the keys and their tessellations.
+   */
+  void getEntries(std::vector<std::pair<TessellationKey, std::shared_ptr<const Tessellation> > >& entries) const;
+
+  /**
+   * clear - Removes every entry. Objects using a tessellation keep it.
+   */
+  void clear();
+
+  /**
+   * resetCounters - Zeroes the hit, miss and eviction counters.
+   */
+  void resetCounters();
+
+  size_t getBudget() const;
+
+  /**
+   * getMemoryUsage - Returns the number of bytes held by the entries,
+   * keys included.
+   */
+  size_t getMemoryUsage() const;
+
+  size_t getEntryCount() const;
+  unsigned long getHits() const;
+  unsigned long getMisses() const;
+  unsigned long getEvictions() const;
+
+  /**
+   * getSnapshotHits - Returns how many of the hits were found in the
+   * snapshot.
+   */
+  unsigned long getSnapshotHits() const;
+};
+
+#endif /* __TESSELLATIONCACHE_H__ */
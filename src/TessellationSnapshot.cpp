@@ -0,0 +1,179 @@
+/**
+ * File: TessellationSnapshot.cpp
+ * Author: agent
+ * Implementation of the TessellationSnapshot class.
+ * File created on 18 October 2026, 07:01
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "main.h"
+#include "TessellationSnapshot.h"
+
+#define SNAPSHOT_VERSION 1
+
+/**
+ * The file starts with a SnapshotHeader, followed by one SnapshotRecord per
+ * tessellation. Each record is followed by its key bytes, its span offsets
+ * (int) and the x, y and z arrays of its points (Scalar), every block
+ * padded to 8 bytes. Numbers are stored in the byte order of the machine,
+ * which the magic string and the stored Scalar size and INC detect.
+ */
+struct SnapshotHeader {
+  char magic[8];
+  unsigned int version;
+  unsigned int scalarSize;
+  double inc;
+  unsigned long long entryCount;
+  unsigned long long fileSize;
+};
+
+struct SnapshotRecord {
+  unsigned long long hash;
+  unsigned long long keySize;
+  unsigned long long pointCount;
+  unsigned long long offsetCount;
+  int rows;
+  int columns;
+};
+
+static const char SNAPSHOT_MAGIC[8] = {'S', 'P', 'L', 'S', 'N', 'A', 'P', '\n'};
+
+static inline size_t padded(size_t size)
+{
+  return (size + 7) & ~(size_t) 7;
+}
+
+static bool writeBlock(FILE* file, const void* data, size_t size)
+{
+  static const char zeros[8] = {0};
+  if(size > 0 && fwrite(data, 1, size, file) != size)
+    return false;
+  size_t padding = padded(size) - size;
+  return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+}
+
+bool TessellationSnapshot::save(const char* path, const TessellationCache& cache)
+{
+  std::vector<std::pair<TessellationKey, std::shared_ptr<const Tessellation> > > entries;
+  cache.getEntries(entries);
+
+  std::string temporary = std::string(path) + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "wb");
+  if(file == NULL)
+    return false;
+  SnapshotHeader header;
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.scalarSize = sizeof(CoreMath::Scalar);
+  header.inc = INC;
+  header.entryCount = entries.size();
+  header.fileSize = 0; //Preenchido no final.
+  bool ok = writeBlock(file, &header, sizeof(header));
+  for(unsigned int e = 0; ok && e < entries.size(); e++) {
+    const TessellationKey& key = entries[e].first;
+    const Tessellation& tessellation = *entries[e].second;
+    SnapshotRecord record;
+    record.hash = key.hash();
+    record.keySize = key.size();
+    record.pointCount = tessellation.points.size();
+    record.offsetCount = tessellation.spanOffsets.size();
+    record.rows = tessellation.rows;
+    record.columns = tessellation.columns;
+    ok = writeBlock(file, &record, sizeof(record)) && writeBlock(file, key.data(), key.size());
+    if(ok && !tessellation.spanOffsets.empty())
+      ok = writeBlock(file, &tessellation.spanOffsets[0], tessellation.spanOffsets.size() * sizeof(int));
+    for(int c = 0; ok && c < 3; c++)
+      ok = writeBlock(file, tessellation.points.component(c), tessellation.points.size() * sizeof(CoreMath::Scalar));
+  }
+  if(ok) {
+    long size = ftell(file);
+    header.fileSize = size;
+    ok = size > 0 && fseek(file, 0, SEEK_SET) == 0 && writeBlock(file, &header, sizeof(header));
+  }
+  ok = fclose(file) == 0 && ok;
+  if(ok)
+    ok = rename(temporary.c_str(), path) == 0;
+  if(!ok)
+    remove(temporary.c_str());
+  return ok;
+}
+
+bool TessellationSnapshot::open(const char* path)
+{
+  close();
+  if(!m_file.open(path))
+    return false;
+  const char* data = m_file.data();
+  size_t size = m_file.size();
+  SnapshotHeader header;
+  if(size < sizeof(header)) {
+    close();
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+     header.scalarSize != sizeof(CoreMath::Scalar) || header.inc != INC || header.fileSize != size) {
+    close();
+    return false;
+  }
+
+  //Only the record headers are read, the points stay on disk until used.
+  size_t position = sizeof(header);
+  for(unsigned long long e = 0; e < header.entryCount; e++) {
+    SnapshotRecord record;
+    if(size - position < sizeof(record)) {
+      close();
+      return false;
+    }
+    memcpy(&record, data + position, sizeof(record));
+    if(record.keySize > size || record.offsetCount > size || record.pointCount > size) {
+      close();
+      return false;
+    }
+    unsigned long long length = sizeof(record) + padded(record.keySize) + padded(record.offsetCount * sizeof(int)) +
+      3 * padded(record.pointCount * sizeof(CoreMath::Scalar));
+    if(length > size - position) {
+      close();
+      return false;
+    }
+    m_index.insert(std::make_pair(record.hash, position));
+    position += length;
+  }
+  return true;
+}
+
+void TessellationSnapshot::close()
+{
+  m_index.clear();
+  m_file.close();
+}
+
+bool TessellationSnapshot::find(const TessellationKey& key, Tessellation& tessellation) const
+{
+  auto range = m_index.equal_range(key.hash());
+  for(auto r = range.first; r != range.second; ++r) {
+    const char* data = m_file.data() + r->second;
+    SnapshotRecord record;
+    memcpy(&record, data, sizeof(record));
+    data += sizeof(record);
+    if(record.keySize != key.size() || memcmp(data, key.data(), key.size()) != 0)
+      continue;
+    data += padded(record.keySize);
+    const int* offsets = (const int*) data;
+    tessellation.spanOffsets.assign(offsets, offsets + record.offsetCount);
+    data += padded(record.offsetCount * sizeof(int));
+    tessellation.points.resize(record.pointCount, false);
+    for(int c = 0; c < 3 && !tessellation.points.empty(); c++) {
+      memcpy(tessellation.points.component(c), data, record.pointCount * sizeof(CoreMath::Scalar));
+      data += padded(record.pointCount * sizeof(CoreMath::Scalar));
+    }
+    tessellation.rows = record.rows;
+    tessellation.columns = record.columns;
+    return true;
+  }
+  return false;
+}
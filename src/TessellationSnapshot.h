@@ -0,0 +1,83 @@
+/**
+ * File: TessellationSnapshot.h
+ * Author: agent
+ * Definition of the TessellationSnapshot class, which keeps the contents
+ * of a TessellationCache on disk between runs.
+ * File created on 18 October 2026, 07:01
+ */
+
+#ifndef __TESSELLATIONSNAPSHOT_H__
+#define __TESSELLATIONSNAPSHOT_H__
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "TessellationCache.h"
+
+/**
+ * TessellationSnapshot - A file holding tessellations together with the
+ * keys (the curve and surface definitions) they were made from. It is
+ * memory mapped and only its index is built when opened, so a snapshot
+ * of tens of thousands of curves opens in a few milliseconds. Attached to
+ * a TessellationCache (see TessellationCache::setSnapshot), the misses of
+ * the cache are looked up in it and copied out of the mapping, so
+ * generateCurve and generateSurface skip the evaluation of every object
+ * that did not change since the snapshot was saved.
+ */
+class TessellationSnapshot {
+private:
+  MappedFile m_file;
+
+  /**
+   * Position in the file of the records with each key hash.
+   */
+  std::unordered_multimap<unsigned long long, size_t> m_index;
+
+  TessellationSnapshot(const TessellationSnapshot&);
+  TessellationSnapshot& operator =(const TessellationSnapshot&);
+public:
+  TessellationSnapshot() {}
+
+  /**
+   * save - Writes the entries of a cache to a snapshot file. The file is
+   * written under a temporary name and renamed at the end, so a snapshot
+   * open elsewhere or an interrupted save never leave a partial file.
+   * @path: The file.
+   * @cache: The cache. Its budget must be large enough to hold all the
+   * tessellations worth saving.
+   * @returns: false if the file could not be written.
+   */
+  static bool save(const char* path, const TessellationCache& cache);
+
+  /**
+   * open - Maps a snapshot file and indexes its records, closing the
+   * current one first.
+   * @path: The file.
+   * @returns: false if the file could not be mapped, is truncated or was
+   * written by another version, another Scalar precision or another INC.
+   * The snapshot is left closed in that case.
+   */
+  bool open(const char* path);
+
+  /**
+   * close - Unmaps the file. Tessellations already copied out of it are
+   * not affected.
+   */
+  void close();
+
+  /**
+   * find - Copies the tessellation of a key out of the snapshot.
+   * @key: The definition of the tessellation.
+   * @tessellation: Receives the tessellation.
+   * @returns: false if the snapshot has no record for the key.
+   */
+  bool find(const TessellationKey& key, Tessellation& tessellation) const;
+
+  inline size_t getEntryCount() const
+  {
+    return m_index.size();
+  }
+};
+
+#endif /* __TESSELLATIONSNAPSHOT_H__ */
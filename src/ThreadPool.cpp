@@ -0,0 +1,136 @@
+/**
+ * File: ThreadPool.cpp
+ * Author: agent
+ * Implementation of the ThreadPool class.
+ * File created on 18 October 2026, 06:09
+ */
+
+#include "ThreadPool.h"
+
+static int threadCount(int threads)
+{
+  if(threads <= 0)
+    threads = (int) std::thread::hardware_concurrency();
+  return threads > 0 ? threads : 1;
+}
+
+ThreadPool::ThreadPool(int threads) : m_queues(threadCount(threads)), m_task(NULL), m_activeWorkers(0), m_generation(0), m_stop(false)
+{
+  for(unsigned int i = 0; i < m_queues.size(); i++)
+    m_queues[i].begin = m_queues[i].end = 0;
+  for(unsigned int i = 1; i < m_queues.size(); i++)
+    m_workers.push_back(std::thread(&ThreadPool::workerLoop, this, (int) i));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for(unsigned int i = 0; i < m_workers.size(); i++)
+    m_workers[i].join();
+}
+
+ThreadPool& ThreadPool::shared()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task)
+{
+  parallelFor(count, [&task](int i, int) { task(i); });
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int, int)>& task)
+{
+  if(count <= 0)
+    return;
+  if(m_workers.empty() || count == 1) {
+    for(int i = 0; i < count; i++)
+      task(i, 0);
+    return;
+  }
+
+  std::lock_guard<std::mutex> call(m_callMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int threads = (int) m_queues.size();
+    for(int t = 0; t < threads; t++) {
+      std::lock_guard<std::mutex> queueLock(m_queues[t].lock);
+      m_queues[t].begin = (int) ((long long) count * t / threads);
+      m_queues[t].end = (int) ((long long) count * (t + 1) / threads);
+    }
+    m_task = &task;
+    m_activeWorkers = (int) m_workers.size();
+    m_generation++;
+  }
+  m_wake.notify_all();
+  runTasks(0);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [this] { return m_activeWorkers == 0; });
+  m_task = NULL;
+}
+
+void ThreadPool::workerLoop(int thread)
+{
+  unsigned int seen = 0;
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this, seen] { return m_stop || m_generation != seen; });
+      if(m_stop)
+        return;
+      seen = m_generation;
+    }
+    runTasks(thread);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(--m_activeWorkers == 0)
+      m_done.notify_one();
+  }
+}
+
+void ThreadPool::runTasks(int thread)
+{
+  int task;
+  do {
+    while(popTask(thread, task))
+      (*m_task)(task, thread);
+  } while(stealTasks(thread));
+}
+
+bool ThreadPool::popTask(int thread, int& task)
+{
+  TaskQueue& queue = m_queues[thread];
+  std::lock_guard<std::mutex> lock(queue.lock);
+  if(queue.begin >= queue.end)
+    return false;
+  task = queue.begin++;
+  return true;
+}
+
+bool ThreadPool::stealTasks(int thread)
+{
+  int threads = (int) m_queues.size();
+  for(int k = 1; k < threads; k++) {
+    TaskQueue& victim = m_queues[(thread + k) % threads];
+    int begin, end;
+    {
+      std::lock_guard<std::mutex> lock(victim.lock);
+      int left = victim.end - victim.begin;
+      if(left <= 0)
+        continue;
+      end = victim.end;
+      begin = end - (left + 1) / 2;
+      victim.end = begin;
+    }
+    std::lock_guard<std::mutex> lock(m_queues[thread].lock);
+    m_queues[thread].begin = begin;
+    m_queues[thread].end = end;
+    return true;
+  }
+  return false;
+}
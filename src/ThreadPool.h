@@ -0,0 +1,92 @@
+/**
+ * File: ThreadPool.h
+ * Author: agent
+ * Definition of the ThreadPool class, a fixed set of worker threads used
+ * to split tessellation work. Tasks are scheduled with work stealing.
+ * File created on 18 October 2026, 06:09
+ */
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class ThreadPool {
+private:
+  /**
+   * TaskQueue - The range of task indices owned by a thread. The owner
+   * takes tasks from the front and idle threads steal the back half.
+   */
+  struct TaskQueue {
+    std::mutex lock;
+    int begin;
+    int end;
+    char padding[64];
+  };
+
+  std::vector<std::thread> m_workers;
+  std::vector<TaskQueue> m_queues;
+  std::mutex m_callMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  const std::function<void(int, int)>* m_task;
+  int m_activeWorkers;
+  unsigned int m_generation;
+  bool m_stop;
+
+  void workerLoop(int thread);
+  void runTasks(int thread);
+  bool popTask(int thread, int& task);
+  bool stealTasks(int thread);
+public:
+  /**
+   * ThreadPool - Starts the worker threads.
+   * @threads: Total number of threads working on a parallelFor, counting
+   * the calling one. Use 0 for one per hardware thread.
+   */
+  ThreadPool(int threads = 0);
+  ~ThreadPool();
+
+  /**
+   * shared - Returns the pool shared by the curves, sized to the
+   * hardware.
+   */
+  static ThreadPool& shared();
+
+  /**
+   * getThreadCount - Returns the number of threads working on a
+   * parallelFor, counting the calling one.
+   */
+  inline int getThreadCount()
+  {
+    return (int) m_workers.size() + 1;
+  }
+
+  /**
+   * parallelFor - Runs task(i, thread) for every i in [0, count) and
+   * returns when all of them are finished. Each thread starts on its own
+   * contiguous block of indices and, once done, steals half of the
+   * remaining block of a busy thread, so uneven tasks are balanced. The
+   * calling thread takes part in the work as thread 0. Tasks must not
+   * call parallelFor on the same pool.
+   * @count: Number of tasks.
+   * @task: The function to be run. Its second argument is the index of
+   * the running thread, in [0, getThreadCount()), which can be used to
+   * pick per thread scratch buffers.
+   */
+  void parallelFor(int count, const std::function<void(int, int)>& task);
+
+  /**
+   * parallelFor - Same as above, for tasks that do not need the thread
+   * index.
+   */
+  void parallelFor(int count, const std::function<void(int)>& task);
+};
+
+#endif /* __THREADPOOL_H__ */
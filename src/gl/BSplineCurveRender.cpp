@@ -0,0 +1,47 @@
+/**
+ * File: BSplineCurveRender.cpp
+ * Author: agent
+ * OpenGL drawing of the B-Spline curve. It is kept out of the evaluation
+ * code so that libsplines builds without GL.
+ * File created on 18 October 2026, 07:20
+ */
+
+#include <GL/glfw.h>
+#include <GL/gl.h>
+
+#include "BSplineCurve.h"
+
+void BSplineCurve::render()
+{
+  updateCurve();
+  //Render the control polygon.
+  glColor4f(0.0f, 1.0f, 1.0f, 0.0f);
+  //Drawn from the homogeneous points, which curves built from a
+  //ControlNetFile have without copying.
+  const double* hx = m_homogeneousPoints.x();
+  const double* hy = m_homogeneousPoints.y();
+  const double* hw = m_homogeneousPoints.w();
+  glBegin(GL_LINES);
+  for(int i = 1; i < m_homogeneousPoints.size(); i++) {
+    glVertex2f(hx[i] / hw[i], hy[i] / hw[i]);
+    glVertex2f(hx[i - 1] / hw[i - 1], hy[i - 1] / hw[i - 1]);
+  }
+  glEnd();
+  //Render the curve.
+  glColor4f(m_color[0], m_color[1], m_color[2], m_color[3]);
+  glBegin(GL_LINES);
+  const RenderPoints& points = currentRenderPoints();
+  const CoreMath::Scalar* x = points.x();
+  const CoreMath::Scalar* y = points.y();
+  for(int i = 1; i < points.size(); i++) {
+    glVertex2f(x[i], y[i]);
+    glVertex2f(x[i - 1], y[i - 1]);
+  }
+  glEnd();
+  //Render the control points.
+  glColor4f(0.0f, 0.0f, 0.0f, 0.0f);
+  glBegin(GL_POINTS);
+  for(int i = 0; i < m_homogeneousPoints.size(); i++)
+    glVertex2f(hx[i] / hw[i], hy[i] / hw[i]);
+  glEnd();
+}
@@ -0,0 +1,22 @@
+/**
+ * File: BSplineSurfaceRender.cpp
+ * Author: agent
+ * OpenGL drawing of the B-Spline surface. It is kept out of the evaluation
+ * code so that libsplines builds without GL.
+ * File created on 18 October 2026, 07:20
+ */
+
+#include <GL/glfw.h>
+#include <GL/gl.h>
+
+#include "BSplineSurface.h"
+
+void BSplineSurface::render() {
+    getRenderPoints();
+    //Render the control polygon.
+    glColor4f(0.0f, 1.0f, 1.0f, 0.0f);
+    //Render the curve.
+    glColor4f(m_color[0], m_color[1], m_color[2], m_color[3]);
+    //Render the control points.
+    glColor4f(0.0f, 0.0f, 0.0f, 0.0f);
+}
@@ -0,0 +1,27 @@
+/**
+ * File: BezierCurveRender.cpp
+ * Author: agent
+ * OpenGL drawing of the Bezier curve. It is kept out of the evaluation
+ * code so that libsplines builds without GL.
+ * File created on 18 October 2026, 07:20
+ */
+
+#include <GL/glfw.h>
+#include <GL/gl.h>
+
+#include "BezierCurve.h"
+
+void BezierCurve::render()
+{
+  m_pendingTransform.apply(m_renderPoints, false);
+  //Render the curve.
+  glColor4f(0.5, 0.0, 0.7, 0.0);
+  glBegin(GL_LINES);
+  const CoreMath::Scalar* x = m_renderPoints.x();
+  const CoreMath::Scalar* y = m_renderPoints.y();
+  for(int i = 1; i < m_renderPoints.size(); i++) {
+    glVertex2f(x[i], y[i]);
+    glVertex2f(x[i - 1], y[i - 1]);
+  }
+  glEnd();
+}
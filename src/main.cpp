@@ -68,27 +68,32 @@ void initCurves()
 
   bs = new BSplineCurve(5, DEGREE);
   bs->setControlPoints(p);
-  bs->generateCurve();
   bs->setColor(1, 0, 0, 0);
 
   bk = new BSplineCurve(5, DEGREE);
   bk->setControlPoints(p);
   bk->setKnotVector(knots);
-  bk->generateCurve();
   bk->setColor(0, 0, 0, 0);
 
   bw = new BSplineCurve(5, DEGREE);
   bw->setControlPoints(p);
   bw->setWeights(weights);
-  bw->generateCurve();
   bw->setColor(0, 0.7, 0, 0);
 
   bb = new BSplineCurve(5, DEGREE);
   bb->setControlPoints(p);
   bb->setKnotVector(knots);
   bb->setWeights(weights);
-  bb->generateCurve();
   bb->setColor(0, 0, 0.9, 0);
+
+  //bs e bw, bk e bb compartilham o vetor de nos, e sem diferencas
+  //progressivas cada par e gerado como uma familia por generateCurves.
+  std::vector<BSplineCurve*> curves;
+  curves.push_back(bs);
+  curves.push_back(bk);
+  curves.push_back(bw);
+  curves.push_back(bb);
+  BSplineCurve::generateCurves(curves);
 }
 
 void initGL(int w, int h)
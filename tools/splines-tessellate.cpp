@@ -0,0 +1,392 @@
+/**
+ * File: splines-tessellate.cpp
+ * Author: agent
+ * Headless batch tessellation of curve definitions, built on libsplines
+ * only: no window, GL or X11 is needed.
+ * File created on 18 October 2026, 07:20
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "main.h"
+#include "BSplineCurve.h"
+#include "BSplineSurface.h"
+#include "ControlNetFile.h"
+
+#define READER_BUFFER (1 << 20)
+#define READER_LOOKAHEAD 256
+
+static const char* usage =
+  "usage: splines-tessellate [options] [input]\n"
+  "\n"
+  "Tessellates the B-Spline curves of input (stdin when missing or -), a\n"
+  "text file of curve definitions or a control net file written by\n"
+  "ControlNetWriter, which may also hold surfaces.\n"
+  "\n"
+  "options:\n"
+  "  -o file    write the points to file instead of stdout\n"
+  "  -b         binary output\n"
+  "  -j         tessellate with all the hardware threads\n"
+  "  -t height  adaptive sampling with this chord height\n"
+  "  -a angle   adaptive sampling with this turn limit, in radians\n"
+  "  -s levels  output the control polygon subdivided levels times\n"
+  "  -n count   curves tessellated per batch (default 1024)\n"
+  "\n"
+  "Text input, with # starting a comment:\n"
+  "  curve <m> <degree>\n"
+  "  [knots <m + degree + 1 values>]\n"
+  "  [weights <m + 1 values>]\n"
+  "  <m + 1 control points, as x y z>\n"
+  "Without knots the knot vector is 0, 1, 2, ..., as in BSplineCurve.\n"
+  "\n"
+  "Text output has a line 'curve <index> <points>' (or 'surface <index>\n"
+  "<rows> <columns>') followed by one 'x y z' line per point. Binary\n"
+  "output has, per object, four ints (0 for a curve or 1 for a surface,\n"
+  "the index, the rows and the columns, 1 for curves) followed by the x,\n"
+  "y and z arrays of rows * columns Scalars.\n";
+
+/**
+ * Reader - Splits a stream into whitespace separated tokens, skipping
+ * comments, with large buffered reads.
+ */
+class Reader {
+private:
+  FILE* m_file;
+  std::vector<char> m_buffer;
+  size_t m_begin, m_end;
+  bool m_eof;
+  int m_line;
+
+  /**
+   * fill - Makes at least READER_LOOKAHEAD bytes available, unless the
+   * stream ends first. The data is kept NUL terminated.
+   */
+  void fill()
+  {
+    if(m_eof || m_end - m_begin >= READER_LOOKAHEAD)
+      return;
+    memmove(&m_buffer[0], &m_buffer[m_begin], m_end - m_begin);
+    m_end -= m_begin;
+    m_begin = 0;
+    while(!m_eof && m_end < READER_LOOKAHEAD) {
+      size_t n = fread(&m_buffer[m_end], 1, m_buffer.size() - 1 - m_end, m_file);
+      m_end += n;
+      m_eof = n == 0;
+    }
+    m_buffer[m_end] = '\0';
+  }
+
+  /**
+   * skip - Moves to the start of the next token, past whitespace and
+   * comments.
+   * @returns: false at the end of the stream.
+   */
+  bool skip()
+  {
+    while(true) {
+      fill();
+      if(m_begin == m_end)
+        return false;
+      char c = m_buffer[m_begin];
+      if(c == '#') {
+        while(m_begin < m_end && m_buffer[m_begin] != '\n') {
+          m_begin++;
+          if(m_begin == m_end)
+            fill();
+        }
+        continue;
+      }
+      if(c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        return true;
+      if(c == '\n')
+        m_line++;
+      m_begin++;
+    }
+  }
+
+  /**
+   * tokenLength - Returns the length of the token at m_begin. Tokens
+   * longer than READER_LOOKAHEAD are cut.
+   */
+  inline size_t tokenLength() const
+  {
+    size_t length = 0;
+    while(m_begin + length < m_end && !strchr(" \t\r\n#", m_buffer[m_begin + length]))
+      length++;
+    return length;
+  }
+public:
+  Reader(FILE* file) : m_file(file), m_buffer(READER_BUFFER + 1), m_begin(0), m_end(0), m_eof(false), m_line(1)
+  {
+    m_buffer[0] = '\0';
+  }
+
+  inline int getLine() const
+  {
+    return m_line;
+  }
+
+  /**
+   * token - Finds the next token.
+   * @start: Receives its first character. It stays valid until the next
+   * call.
+   * @length: Receives its length.
+   * @returns: false at the end of the stream.
+   */
+  bool token(const char*& start, size_t& length)
+  {
+    if(!skip())
+      return false;
+    start = &m_buffer[m_begin];
+    length = tokenLength();
+    m_begin += length;
+    return true;
+  }
+
+  /**
+   * word - Reads the next token if it is the given word.
+   * @returns: false, consuming nothing, when it is not.
+   */
+  bool word(const char* expected)
+  {
+    if(!skip())
+      return false;
+    size_t length = tokenLength();
+    if(length != strlen(expected) || memcmp(&m_buffer[m_begin], expected, length) != 0)
+      return false;
+    m_begin += length;
+    return true;
+  }
+
+  /**
+   * number - Reads the next token as a number.
+   * @returns: false at the end of the stream or when it is not a number.
+   */
+  bool number(double& value)
+  {
+    const char* start;
+    size_t length;
+    if(!token(start, length))
+      return false;
+    char* end;
+    value = strtod(start, &end);
+    return end == start + length;
+  }
+};
+
+struct Options {
+  const char* input;
+  const char* output;
+  bool binary;
+  bool parallel;
+  AdaptiveTolerance tolerance;
+  int subdivisionLevels;
+  int batch;
+};
+
+static void fail(const char* message, int line = 0)
+{
+  if(line > 0)
+    fprintf(stderr, "splines-tessellate: line %d: %s\n", line, message);
+  else
+    fprintf(stderr, "splines-tessellate: %s\n", message);
+  exit(1);
+}
+
+static void writePoints(FILE* out, const Options& options, int kind, int index, int rows, int columns, const RenderPoints& points)
+{
+  if(options.binary) {
+    int header[4] = {kind, index, rows, columns};
+    bool ok = fwrite(header, sizeof(header), 1, out) == 1;
+    for(int c = 0; c < 3 && ok && !points.empty(); c++)
+      ok = fwrite(points.component(c), sizeof(CoreMath::Scalar), points.size(), out) == (size_t) points.size();
+    if(!ok)
+      fail("write error");
+    return;
+  }
+  if(kind == 0)
+    fprintf(out, "curve %d %d\n", index, points.size());
+  else
+    fprintf(out, "surface %d %d %d\n", index, rows, columns);
+  const char* format = sizeof(CoreMath::Scalar) == sizeof(float) ? "%.9g %.9g %.9g\n" : "%.17g %.17g %.17g\n";
+  const CoreMath::Scalar* x = points.x();
+  const CoreMath::Scalar* y = points.y();
+  const CoreMath::Scalar* z = points.z();
+  for(int i = 0; i < points.size(); i++)
+    fprintf(out, format, (double) x[i], (double) y[i], (double) z[i]);
+  if(ferror(out))
+    fail("write error");
+}
+
+/**
+ * tessellateBatch - Tessellates and writes a batch of curves, then
+ * deletes them.
+ * @first: Index of the first curve of the batch in the input.
+ */
+static void tessellateBatch(FILE* out, const Options& options, std::vector<BSplineCurve*>& curves, int first)
+{
+  for(unsigned int c = 0; c < curves.size(); c++) {
+    curves[c]->setParallel(options.parallel);
+    curves[c]->setAdaptiveTolerance(options.tolerance);
+    curves[c]->setSubdivisionLevels(options.subdivisionLevels);
+  }
+  BSplineCurve::generateCurves(curves, options.parallel);
+  for(unsigned int c = 0; c < curves.size(); c++) {
+    const RenderPoints& points = curves[c]->getRenderPoints();
+    writePoints(out, options, 0, first + c, points.size(), 1, points);
+    delete curves[c];
+  }
+  curves.clear();
+}
+
+/**
+ * readCurve - Parses the definition of a curve after its 'curve' keyword.
+ */
+static BSplineCurve* readCurve(Reader& reader)
+{
+  double m, degree;
+  if(!reader.number(m) || !reader.number(degree) || m != (int) m || degree != (int) degree || degree < 1 || m < degree)
+    fail("expected <m> <degree>, with 1 <= degree <= m", reader.getLine());
+  BSplineCurve* curve = new BSplineCurve((int) m, (int) degree);
+  if(reader.word("knots")) {
+    std::vector<double> knots((int) m + (int) degree + 1);
+    for(unsigned int i = 0; i < knots.size(); i++)
+      if(!reader.number(knots[i]) || (i > 0 && knots[i] < knots[i - 1]))
+        fail("expected m + degree + 1 nondecreasing knots", reader.getLine());
+    curve->setKnotVector(&knots[0]);
+  }
+  std::vector<double> weights((int) m + 1, 1.0);
+  if(reader.word("weights"))
+    for(unsigned int i = 0; i < weights.size(); i++)
+      if(!reader.number(weights[i]) || weights[i] <= 0.0)
+        fail("expected m + 1 positive weights", reader.getLine());
+  std::vector<CoreMath::Vector4> points((int) m + 1);
+  for(unsigned int i = 0; i < points.size(); i++) {
+    double p[3];
+    for(int k = 0; k < 3; k++)
+      if(!reader.number(p[k]))
+        fail("expected m + 1 control points as x y z", reader.getLine());
+    points[i] = CoreMath::Vector4(p[0], p[1], p[2]);
+  }
+  curve->setControlPoints(std::move(points));
+  curve->setWeights(&weights[0]);
+  return curve;
+}
+
+static void tessellateText(FILE* in, FILE* out, const Options& options)
+{
+  Reader reader(in);
+  std::vector<BSplineCurve*> curves;
+  int count = 0;
+  const char* start;
+  size_t length;
+  while(reader.token(start, length)) {
+    if(length != 5 || memcmp(start, "curve", 5) != 0)
+      fail("expected 'curve'", reader.getLine());
+    curves.push_back(readCurve(reader));
+    if((int) curves.size() == options.batch) {
+      tessellateBatch(out, options, curves, count);
+      count += options.batch;
+    }
+  }
+  tessellateBatch(out, options, curves, count);
+}
+
+static void tessellateNet(const std::shared_ptr<const ControlNetFile>& net, FILE* out, const Options& options)
+{
+  std::vector<BSplineCurve*> curves;
+  for(int first = 0; first < net->getCurveCount(); first += options.batch) {
+    for(int i = first; i < net->getCurveCount() && i < first + options.batch; i++)
+      curves.push_back(new BSplineCurve(net, i));
+    tessellateBatch(out, options, curves, first);
+  }
+  for(int i = 0; i < net->getSurfaceCount(); i++) {
+    BSplineSurface surface(net, i);
+    surface.setParallel(options.parallel);
+    surface.generateSurface();
+    writePoints(out, options, 1, i, surface.getRenderRows(), surface.getRenderColumns(), surface.getRenderPoints());
+  }
+}
+
+static void usageError()
+{
+  fputs(usage, stderr);
+  exit(1);
+}
+
+static double argumentNumber(int argc, char** argv, int& i)
+{
+  char* end;
+  if(i + 1 >= argc)
+    usageError();
+  double value = strtod(argv[++i], &end);
+  if(*end != '\0')
+    usageError();
+  return value;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  options.input = NULL;
+  options.output = NULL;
+  options.binary = false;
+  options.parallel = false;
+  options.subdivisionLevels = 0;
+  options.batch = 1024;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-o") && i + 1 < argc)
+      options.output = argv[++i];
+    else if(!strcmp(argv[i], "-b"))
+      options.binary = true;
+    else if(!strcmp(argv[i], "-j"))
+      options.parallel = true;
+    else if(!strcmp(argv[i], "-t"))
+      options.tolerance.chordHeight = argumentNumber(argc, argv, i);
+    else if(!strcmp(argv[i], "-a"))
+      options.tolerance.angle = argumentNumber(argc, argv, i);
+    else if(!strcmp(argv[i], "-s"))
+      options.subdivisionLevels = (int) argumentNumber(argc, argv, i);
+    else if(!strcmp(argv[i], "-n"))
+      options.batch = (int) argumentNumber(argc, argv, i);
+    else if(!strcmp(argv[i], "-h")) {
+      fputs(usage, stdout);
+      return 0;
+    }
+    else if(argv[i][0] == '-' && argv[i][1] != '\0')
+      usageError();
+    else if(options.input == NULL)
+      options.input = argv[i];
+    else
+      usageError();
+  }
+  if(options.batch < 1)
+    options.batch = 1;
+
+  FILE* out = stdout;
+  if(options.output != NULL && (out = fopen(options.output, options.binary ? "wb" : "w")) == NULL)
+    fail("cannot open the output file");
+  static char outputBuffer[READER_BUFFER];
+  setvbuf(out, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+  bool useStdin = options.input == NULL || !strcmp(options.input, "-");
+  std::shared_ptr<ControlNetFile> net(new ControlNetFile);
+  if(!useStdin && net->open(options.input))
+    tessellateNet(net, out, options);
+  else {
+    FILE* in = useStdin ? stdin : fopen(options.input, "r");
+    if(in == NULL)
+      fail("cannot open the input file");
+    tessellateText(in, out, options);
+    if(in != stdin)
+      fclose(in);
+  }
+  if(fclose(out) != 0)
+    fail("write error");
+  return 0;
+}